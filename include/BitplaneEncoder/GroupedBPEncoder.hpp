@@ -15,12 +15,12 @@ namespace MDR {
             static_assert(std::is_integral<T_stream>::value, "GroupedBPBlockEncoder: streams must be unsigned integers.");
         }
 
-        std::vector<uint8_t *> encode(T_data const * data, int32_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint32_t>& stream_sizes) const {
+        std::vector<uint8_t *> encode(T_data const * data, size_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint64_t>& stream_sizes) const {
             assert(num_bitplanes > 0);
             // determine block size based on bitplane integer type
             uint32_t block_size = block_size_based_on_bitplane_int_type<T_stream>();
             std::vector<uint8_t> starting_bitplanes = std::vector<uint8_t>((n - 1)/block_size + 1, 0);
-            stream_sizes = std::vector<uint32_t>(num_bitplanes, 0);
+            stream_sizes = std::vector<uint64_t>(num_bitplanes, 0);
             // define fixed point type
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
             std::vector<uint8_t *> streams;
@@ -33,8 +33,8 @@ namespace MDR {
                 streams_pos[i] = reinterpret_cast<T_stream*>(streams[i]);
             }
             T_data const * data_pos = data;
-            int block_id=0;
-            for(int i=0; i<n - block_size; i+=block_size){
+            size_t block_id=0;
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 T_stream sign_bitplane = 0;
                 for(int j=0; j<block_size; j++){
                     T_data cur_data = *(data_pos++);
@@ -48,7 +48,7 @@ namespace MDR {
             }
             // leftover
             {
-                int rest_size = n - block_size * block_id;
+                size_t rest_size = n - block_size * block_id;
                 T_stream sign_bitplane = 0;
                 for(int j=0; j<rest_size; j++){
                     T_data cur_data = *(data_pos++);
@@ -64,7 +64,7 @@ namespace MDR {
                 stream_sizes[i] = reinterpret_cast<uint8_t*>(streams_pos[i]) - streams[i];
             }
             // merge starting_bitplane with the first bitplane
-            uint32_t merged_size = 0;
+            uint64_t merged_size = 0;
             uint8_t * merged = merge_arrays(reinterpret_cast<uint8_t const*>(starting_bitplanes.data()), starting_bitplanes.size() * sizeof(uint8_t), reinterpret_cast<uint8_t*>(streams[0]), stream_sizes[0], merged_size);
             free(streams[0]);
             streams[0] = merged;
@@ -73,12 +73,18 @@ namespace MDR {
         }
 
         // only differs in error collection
-        std::vector<uint8_t *> encode(T_data const * data, int32_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint32_t>& stream_sizes, std::vector<double>& level_errors) const {
+        std::vector<uint8_t *> encode(T_data const * data, size_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint64_t>& stream_sizes, std::vector<double>& level_errors) const {
+            std::vector<double> level_max_errors;
+            return encode(data, n, exp, num_bitplanes, stream_sizes, level_errors, level_max_errors);
+        }
+
+        // also records the max error of each truncation
+        std::vector<uint8_t *> encode(T_data const * data, size_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint64_t>& stream_sizes, std::vector<double>& level_errors, std::vector<double>& level_max_errors) const {
             assert(num_bitplanes > 0);
             // determine block size based on bitplane integer type
             uint32_t block_size = block_size_based_on_bitplane_int_type<T_stream>();
             std::vector<uint8_t> starting_bitplanes = std::vector<uint8_t>((n - 1)/block_size + 1, 0);
-            stream_sizes = std::vector<uint32_t>(num_bitplanes, 0);
+            stream_sizes = std::vector<uint64_t>(num_bitplanes, 0);
             // define fixed point type
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
             std::vector<uint8_t *> streams;
@@ -96,15 +102,16 @@ namespace MDR {
             for(int i=0; i<level_errors.size(); i++){
                 level_errors[i] = 0;
             }
+            level_max_errors = std::vector<double>(num_bitplanes + 1, 0);
             T_data const * data_pos = data;
-            int block_id=0;
-            for(int i=0; i<n - block_size; i+=block_size){
+            size_t block_id=0;
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 T_stream sign_bitplane = 0;
                 for(int j=0; j<block_size; j++){
                     T_data cur_data = *(data_pos++);
                     T_data shifted_data = ldexp(cur_data, num_bitplanes - exp);
                     // compute level errors
-                    collect_level_errors(level_errors, fabs(shifted_data), num_bitplanes);
+                    collect_level_errors(level_errors, level_max_errors, fabs(shifted_data), num_bitplanes);
                     int64_t fix_point = (int64_t) shifted_data;
                     T_stream sign = cur_data < 0;
                     int_data_buffer[j] = sign ? -fix_point : +fix_point;
@@ -114,13 +121,13 @@ namespace MDR {
             }
             // leftover
             {
-                int rest_size = n - block_size * block_id;
+                size_t rest_size = n - block_size * block_id;
                 T_stream sign_bitplane = 0;
                 for(int j=0; j<rest_size; j++){
                     T_data cur_data = *(data_pos++);
                     T_data shifted_data = ldexp(cur_data, num_bitplanes - exp);
                     // compute level errors
-                    collect_level_errors(level_errors, fabs(shifted_data), num_bitplanes);
+                    collect_level_errors(level_errors, level_max_errors, fabs(shifted_data), num_bitplanes);
                     int64_t fix_point = (int64_t) shifted_data;
                     T_stream sign = cur_data < 0;
                     int_data_buffer[j] = sign ? -fix_point : +fix_point;
@@ -132,7 +139,7 @@ namespace MDR {
                 stream_sizes[i] = reinterpret_cast<uint8_t*>(streams_pos[i]) - streams[i];
             }
             // merge starting_bitplane with the first bitplane
-            uint32_t merged_size = 0;
+            uint64_t merged_size = 0;
             uint8_t * merged = merge_arrays(reinterpret_cast<uint8_t const*>(starting_bitplanes.data()), starting_bitplanes.size() * sizeof(uint8_t), reinterpret_cast<uint8_t*>(streams[0]), stream_sizes[0], merged_size);
             free(streams[0]);
             streams[0] = merged;
@@ -140,11 +147,12 @@ namespace MDR {
             // translate level errors
             for(int i=0; i<level_errors.size(); i++){
                 level_errors[i] = ldexp(level_errors[i], 2*(- num_bitplanes + exp));
+                level_max_errors[i] = ldexp(level_max_errors[i], - num_bitplanes + exp);
             }
             return streams;
         }
 
-        T_data * decode(const std::vector<uint8_t const *>& streams, int32_t n, int exp, uint8_t num_bitplanes) {
+        T_data * decode(const std::vector<uint8_t const *>& streams, size_t n, int exp, uint8_t num_bitplanes) {
             uint32_t block_size = block_size_based_on_bitplane_int_type<T_stream>();
             // define fixed point type
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
@@ -165,8 +173,8 @@ namespace MDR {
             std::vector<T_fp> int_data_buffer(block_size, 0);
             // decode
             T_data * data_pos = data;
-            int block_id = 0;
-            for(int i=0; i<n - block_size; i+=block_size){
+            size_t block_id = 0;
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 uint8_t recording_bitplane = recording_bitplanes[block_id ++];
                 if(recording_bitplane < num_bitplanes){
                     memset(int_data_buffer.data(), 0, block_size * sizeof(T_fp));
@@ -185,7 +193,7 @@ namespace MDR {
             }
             // leftover
             {
-                int rest_size = n - block_size * block_id;
+                size_t rest_size = n - block_size * block_id;
                 int recording_bitplane = recording_bitplanes[block_id];
                 T_stream sign_bitplane = 0;
                 if(recording_bitplane < num_bitplanes){
@@ -207,7 +215,7 @@ namespace MDR {
         }
 
         // decode the data and record necessary information for progressiveness
-        T_data * progressive_decode(const std::vector<uint8_t const *>& streams, int32_t n, int exp, uint8_t starting_bitplane, uint8_t num_bitplanes, int level) {
+        T_data * progressive_decode(const std::vector<uint8_t const *>& streams, size_t n, int exp, uint8_t starting_bitplane, uint8_t num_bitplanes, int level) {
             uint32_t block_size = block_size_based_on_bitplane_int_type<T_stream>();
             // define fixed point type
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
@@ -238,8 +246,8 @@ namespace MDR {
             const uint8_t ending_bitplane = starting_bitplane + num_bitplanes;
             // decode
             T_data * data_pos = data;
-            int block_id = 0;
-            for(int i=0; i<n - block_size; i+=block_size){
+            size_t block_id = 0;
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 uint8_t recording_bitplane = recording_bitplanes[block_id ++];
                 if(recording_bitplane < ending_bitplane){
                     memset(int_data_buffer.data(), 0, block_size * sizeof(T_fp));
@@ -267,7 +275,7 @@ namespace MDR {
             }
             // leftover
             {
-                int rest_size = n - block_size * block_id;
+                size_t rest_size = n - block_size * block_id;
                 uint8_t recording_bitplane = recording_bitplanes[block_id];
                 if(recording_bitplane < ending_bitplane){
                     memset(int_data_buffer.data(), 0, block_size * sizeof(T_fp));
@@ -321,17 +329,21 @@ namespace MDR {
             }
             return block_size;
         }
-        inline void collect_level_errors(std::vector<double>& level_errors, float data, int num_bitplanes) const {
-            uint32_t fp_data = (uint32_t) data;
-            double mantissa = data - (uint32_t) data;
+        // data is the magnitude shifted by num_bitplanes (up to 64), so the integer part is kept in 64 bits
+        inline void collect_level_errors(std::vector<double>& level_errors, std::vector<double>& level_max_errors, T_data data, int num_bitplanes) const {
+            uint64_t fp_data = (uint64_t) data;
+            double mantissa = data - (T_data) fp_data;
             level_errors[num_bitplanes] += mantissa * mantissa;
+            level_max_errors[num_bitplanes] = std::max(level_max_errors[num_bitplanes], mantissa);
             for(int k=1; k<num_bitplanes; k++){
-                uint32_t mask = (1 << k) - 1;
+                uint64_t mask = ((uint64_t) 1 << k) - 1;
                 double diff = (double) (fp_data & mask) + mantissa;
                 level_errors[num_bitplanes - k] += diff * diff;
+                level_max_errors[num_bitplanes - k] = std::max(level_max_errors[num_bitplanes - k], diff);
             }
             double diff = fp_data + mantissa;
-            level_errors[0] += data * data;
+            level_errors[0] += (double) data * data;
+            level_max_errors[0] = std::max(level_max_errors[0], (double) data);
         }
 
         template <class T_int>
@@ -367,7 +379,7 @@ namespace MDR {
             }
         }
 
-        uint8_t * merge_arrays(uint8_t const * array1, uint32_t size1, uint8_t const * array2, uint32_t size2, uint32_t& merged_size) const {
+        uint8_t * merge_arrays(uint8_t const * array1, uint32_t size1, uint8_t const * array2, uint64_t size2, uint64_t& merged_size) const {
             merged_size = sizeof(uint32_t) + size1 + size2;
             uint8_t * merged_array = (uint8_t *) malloc(merged_size);
             *reinterpret_cast<uint32_t*>(merged_array) = size1;
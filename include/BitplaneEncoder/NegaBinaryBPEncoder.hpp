@@ -15,14 +15,14 @@ namespace MDR {
             static_assert(std::is_integral<T_stream>::value, "NegaBinaryEncoder: streams must be unsigned integers.");
         }
 
-        std::vector<uint8_t *> encode(T_data const * data, int32_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint32_t>& stream_sizes) const {
+        std::vector<uint8_t *> encode(T_data const * data, size_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint64_t>& stream_sizes) const {
             assert(num_bitplanes > 0);
             // leave room for negabinary format
             exp += 2;
             // determine block size based on bitplane integer type
             uint32_t block_size = block_size_based_on_bitplane_int_type<T_stream>();
             std::vector<uint8_t> starting_bitplanes = std::vector<uint8_t>((n - 1)/block_size + 1, 0);
-            stream_sizes = std::vector<uint32_t>(num_bitplanes, 0);
+            stream_sizes = std::vector<uint64_t>(num_bitplanes, 0);
             // define fixed point type
             using T_fps = typename std::conditional<std::is_same<T_data, double>::value, int64_t, int32_t>::type;
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
@@ -36,7 +36,7 @@ namespace MDR {
                 streams_pos[i] = reinterpret_cast<T_stream*>(streams[i]);
             }
             T_data const * data_pos = data;
-            for(int i=0; i<n - block_size; i+=block_size){
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 for(int j=0; j<block_size; j++){
                     T_data cur_data = *(data_pos++);
                     T_data shifted_data = ldexp(cur_data, num_bitplanes - exp);
@@ -46,7 +46,7 @@ namespace MDR {
             }
             // leftover
             {
-                int rest_size = n % block_size;
+                size_t rest_size = n % block_size;
                 if(rest_size == 0) rest_size = block_size;
                 for(int j=0; j<rest_size; j++){
                     T_data cur_data = *(data_pos++);
@@ -62,14 +62,20 @@ namespace MDR {
         }
 
         // only differs in error collection
-        std::vector<uint8_t *> encode(T_data const * data, int32_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint32_t>& stream_sizes, std::vector<double>& level_errors) const {
+        std::vector<uint8_t *> encode(T_data const * data, size_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint64_t>& stream_sizes, std::vector<double>& level_errors) const {
+            std::vector<double> level_max_errors;
+            return encode(data, n, exp, num_bitplanes, stream_sizes, level_errors, level_max_errors);
+        }
+
+        // also records the max error of each truncation
+        std::vector<uint8_t *> encode(T_data const * data, size_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint64_t>& stream_sizes, std::vector<double>& level_errors, std::vector<double>& level_max_errors) const {
             assert(num_bitplanes > 0);
             // leave room for negabinary format
             exp += 2;
             // determine block size based on bitplane integer type
             uint32_t block_size = block_size_based_on_bitplane_int_type<T_stream>();
             std::vector<uint8_t> starting_bitplanes = std::vector<uint8_t>((n - 1)/block_size + 1, 0);
-            stream_sizes = std::vector<uint32_t>(num_bitplanes, 0);
+            stream_sizes = std::vector<uint64_t>(num_bitplanes, 0);
             // define fixed point type
             using T_fps = typename std::conditional<std::is_same<T_data, double>::value, int64_t, int32_t>::type;
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
@@ -88,21 +94,22 @@ namespace MDR {
             for(int i=0; i<level_errors.size(); i++){
                 level_errors[i] = 0;
             }
+            level_max_errors = std::vector<double>(num_bitplanes + 1, 0);
             T_data const * data_pos = data;
-            for(int i=0; i<n - block_size; i+=block_size){
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 for(int j=0; j<block_size; j++){
                     T_data cur_data = *(data_pos++);
                     T_data shifted_data = ldexp(cur_data, num_bitplanes - exp);
                     T_fps signed_int_data = (T_fps) shifted_data;
                     int_data_buffer[j] = binary2negabinary(signed_int_data);
                     // compute level errors
-                    collect_level_errors(level_errors, int_data_buffer[j], shifted_data, shifted_data - signed_int_data, num_bitplanes);
+                    collect_level_errors(level_errors, level_max_errors, int_data_buffer[j], shifted_data, shifted_data - signed_int_data, num_bitplanes);
                 }
                 encode_block(int_data_buffer.data(), block_size, num_bitplanes, streams_pos);
             }
             // leftover
             {
-                int rest_size = n % block_size;
+                size_t rest_size = n % block_size;
                 if(rest_size == 0) rest_size = block_size;
                 for(int j=0; j<rest_size; j++){
                     T_data cur_data = *(data_pos++);
@@ -110,7 +117,7 @@ namespace MDR {
                     T_fps signed_int_data = (T_fps) shifted_data;
                     int_data_buffer[j] = binary2negabinary(signed_int_data);
                     // compute level errors
-                    collect_level_errors(level_errors, int_data_buffer[j], shifted_data, shifted_data - signed_int_data, num_bitplanes);
+                    collect_level_errors(level_errors, level_max_errors, int_data_buffer[j], shifted_data, shifted_data - signed_int_data, num_bitplanes);
                 }
                 encode_block(int_data_buffer.data(), rest_size, num_bitplanes, streams_pos);
             }
@@ -120,16 +127,72 @@ namespace MDR {
             // translate level errors
             for(int i=0; i<level_errors.size(); i++){
                 level_errors[i] = ldexp(level_errors[i], 2*(- num_bitplanes + exp));
+                level_max_errors[i] = ldexp(level_max_errors[i], - num_bitplanes + exp);
+            }
+            return streams;
+        }
+
+        // encode with error collection, handing bitplanes to a streaming compressor chunk by chunk
+        // only one chunk per bitplane is in the encoder at a time; returns the compressed streams
+        template<class StreamingCompressor>
+        std::vector<uint8_t *> encode_streaming(T_data const * data, size_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint64_t>& stream_sizes, std::vector<double>& level_errors, std::vector<double>& level_max_errors, StreamingCompressor& compressor) const {
+            assert(num_bitplanes > 0);
+            // leave room for negabinary format
+            exp += 2;
+            // determine block size based on bitplane integer type
+            uint32_t block_size = block_size_based_on_bitplane_int_type<T_stream>();
+            const size_t num_blocks = (n - 1)/block_size + 1;
+            const size_t chunk_blocks = std::max<size_t>(compressor.get_chunk_size() / sizeof(T_stream), 1);
+            // define fixed point type
+            using T_fps = typename std::conditional<std::is_same<T_data, double>::value, int64_t, int32_t>::type;
+            using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
+            std::vector<T_fp> int_data_buffer(block_size, 0);
+            std::vector<T_stream *> streams_pos(num_bitplanes);
+            // init level errors
+            level_errors.clear();
+            level_errors.resize(num_bitplanes + 1);
+            for(int i=0; i<level_errors.size(); i++){
+                level_errors[i] = 0;
+            }
+            level_max_errors = std::vector<double>(num_bitplanes + 1, 0);
+            compressor.begin_level(num_bitplanes, num_blocks * sizeof(T_stream));
+            T_data const * data_pos = data;
+            for(size_t block_id=0; block_id<num_blocks; block_id+=chunk_blocks){
+                const std::vector<uint8_t *>& chunk = compressor.begin_chunk();
+                for(int i=0; i<num_bitplanes; i++){
+                    streams_pos[i] = reinterpret_cast<T_stream*>(chunk[i]);
+                }
+                const size_t num_chunk_blocks = std::min(chunk_blocks, num_blocks - block_id);
+                for(size_t b=0; b<num_chunk_blocks; b++){
+                    // the last block holds the leftover
+                    size_t cur_block_size = (block_id + b == num_blocks - 1) ? n - (num_blocks - 1) * block_size : block_size;
+                    for(int j=0; j<cur_block_size; j++){
+                        T_data cur_data = *(data_pos++);
+                        T_data shifted_data = ldexp(cur_data, num_bitplanes - exp);
+                        T_fps signed_int_data = (T_fps) shifted_data;
+                        int_data_buffer[j] = binary2negabinary(signed_int_data);
+                        // compute level errors
+                        collect_level_errors(level_errors, level_max_errors, int_data_buffer[j], shifted_data, shifted_data - signed_int_data, num_bitplanes);
+                    }
+                    encode_block(int_data_buffer.data(), cur_block_size, num_bitplanes, streams_pos);
+                }
+                compressor.end_chunk(num_chunk_blocks * sizeof(T_stream));
+            }
+            auto streams = compressor.end_level(stream_sizes);
+            // translate level errors
+            for(int i=0; i<level_errors.size(); i++){
+                level_errors[i] = ldexp(level_errors[i], 2*(- num_bitplanes + exp));
+                level_max_errors[i] = ldexp(level_max_errors[i], - num_bitplanes + exp);
             }
             return streams;
         }
 
-        T_data * decode(const std::vector<uint8_t const *>& streams, int32_t n, int exp, uint8_t num_bitplanes) {
+        T_data * decode(const std::vector<uint8_t const *>& streams, size_t n, int exp, uint8_t num_bitplanes) {
             return progressive_decode(streams, n, exp, 0, num_bitplanes, streams.size());
         }
 
         // decode the data and record necessary information for progressiveness
-        T_data * progressive_decode(const std::vector<uint8_t const *>& streams, int32_t n, int exp, uint8_t starting_bitplane, uint8_t num_bitplanes, int level) {
+        T_data * progressive_decode(const std::vector<uint8_t const *>& streams, size_t n, int exp, uint8_t starting_bitplane, uint8_t num_bitplanes, int level) {
             uint32_t block_size = block_size_based_on_bitplane_int_type<T_stream>();
             T_data * data = (T_data *) malloc(n * sizeof(T_data));
             if(num_bitplanes == 0){
@@ -151,7 +214,7 @@ namespace MDR {
             T_data * data_pos = data;
             // std::cout << "ending_bitplane = " << +ending_bitplane << std::endl;
             if(ending_bitplane % 2 == 0){
-                for(int i=0; i<n - block_size; i+=block_size){
+                for(size_t i=0; i + block_size < n; i+=block_size){
                     memset(int_data_buffer.data(), 0, block_size * sizeof(T_fp));
                     decode_block(streams_pos, block_size, num_bitplanes, int_data_buffer.data());
                     for(int j=0; j<block_size; j++){
@@ -160,7 +223,7 @@ namespace MDR {
                 }
                 // leftover
                 {
-                    int rest_size = n % block_size;
+                    size_t rest_size = n % block_size;
                     if(rest_size == 0) rest_size = block_size;
                     memset(int_data_buffer.data(), 0, rest_size * sizeof(T_fp));
                     decode_block(streams_pos, rest_size, num_bitplanes, int_data_buffer.data());
@@ -170,7 +233,7 @@ namespace MDR {
                 }                
             }
             else{
-                for(int i=0; i<n - block_size; i+=block_size){
+                for(size_t i=0; i + block_size < n; i+=block_size){
                     memset(int_data_buffer.data(), 0, block_size * sizeof(T_fp));
                     decode_block(streams_pos, block_size, num_bitplanes, int_data_buffer.data());
                     for(int j=0; j<block_size; j++){
@@ -179,7 +242,7 @@ namespace MDR {
                 }
                 // leftover
                 {
-                    int rest_size = n % block_size;
+                    size_t rest_size = n % block_size;
                     if(rest_size == 0) rest_size = block_size;
                     memset(int_data_buffer.data(), 0, rest_size * sizeof(T_fp));
                     decode_block(streams_pos, rest_size, num_bitplanes, int_data_buffer.data());
@@ -228,14 +291,19 @@ namespace MDR {
         inline int32_t negabinary2binary(const uint32_t x) const {
             return (x ^0xaaaaaaaau) - 0xaaaaaaaau;
         }
-        inline void collect_level_errors(std::vector<double>& level_errors, uint32_t negabinary_data, float data, float mantissa, int num_bitplanes) const {
-            level_errors[num_bitplanes] += mantissa * mantissa;
+        // T_fp is uint32_t for float and uint64_t for double, so the mask and the decoded prefix keep every bitplane
+        template <class T_fp>
+        inline void collect_level_errors(std::vector<double>& level_errors, std::vector<double>& level_max_errors, T_fp negabinary_data, T_data data, T_data mantissa, int num_bitplanes) const {
+            level_errors[num_bitplanes] += (double) mantissa * mantissa;
+            level_max_errors[num_bitplanes] = std::max(level_max_errors[num_bitplanes], (double) fabs(mantissa));
             for(int k=1; k<num_bitplanes; k++){
-                uint32_t mask = (1 << k) - 1;
+                T_fp mask = ((T_fp) 1 << k) - 1;
                 double diff = (double) negabinary2binary(negabinary_data & mask) + mantissa;
                 level_errors[num_bitplanes - k] += diff * diff;
+                level_max_errors[num_bitplanes - k] = std::max(level_max_errors[num_bitplanes - k], fabs(diff));
             }
-            level_errors[0] += data * data;
+            level_errors[0] += (double) data * data;
+            level_max_errors[0] = std::max(level_max_errors[0], (double) fabs(data));
         }
         template <class T_int>
         inline void encode_block(T_int const * data, size_t n, uint8_t num_bitplanes, std::vector<T_stream *>& streams_pos) const {
@@ -78,11 +78,11 @@ namespace MDR {
             static_assert(std::is_integral<T_stream>::value, "PerBitBPEncoder: streams must be unsigned integers.");
         }
 
-        std::vector<uint8_t *> encode(T_data const * data, int32_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint32_t>& stream_sizes) const {
+        std::vector<uint8_t *> encode(T_data const * data, size_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint64_t>& stream_sizes) const {
             assert(num_bitplanes > 0);
             // determine block size based on bitplane integer type
             const int32_t block_size = PER_BIT_BLOCK_SIZE;
-            stream_sizes = std::vector<uint32_t>(num_bitplanes, 0);
+            stream_sizes = std::vector<uint64_t>(num_bitplanes, 0);
             // define fixed point type
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
             std::vector<uint8_t *> streams;
@@ -94,7 +94,7 @@ namespace MDR {
                 encoders.push_back(BitEncoder(reinterpret_cast<uint64_t*>(streams[i])));
             }
             T_data const * data_pos = data;
-            for(int i=0; i<n - block_size; i+=block_size){
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 T_stream sign_bitplane = 0;
                 for(int j=0; j<block_size; j++){
                     T_data cur_data = *(data_pos++);
@@ -117,7 +117,7 @@ namespace MDR {
             }
             // leftover
             {
-                int rest_size = n % block_size;
+                size_t rest_size = n % block_size;
                 if(rest_size == 0) rest_size = block_size;
                 for(int j=0; j<rest_size; j++){
                     T_data cur_data = *(data_pos++);
@@ -146,11 +146,17 @@ namespace MDR {
         }
 
         // only differs in error collection
-        std::vector<uint8_t *> encode(T_data const * data, int32_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint32_t>& stream_sizes, std::vector<double>& level_errors) const {
+        std::vector<uint8_t *> encode(T_data const * data, size_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint64_t>& stream_sizes, std::vector<double>& level_errors) const {
+            std::vector<double> level_max_errors;
+            return encode(data, n, exp, num_bitplanes, stream_sizes, level_errors, level_max_errors);
+        }
+
+        // also records the max error of each truncation
+        std::vector<uint8_t *> encode(T_data const * data, size_t n, int32_t exp, uint8_t num_bitplanes, std::vector<uint64_t>& stream_sizes, std::vector<double>& level_errors, std::vector<double>& level_max_errors) const {
             assert(num_bitplanes > 0);
             // determine block size based on bitplane integer type
             const int32_t block_size = PER_BIT_BLOCK_SIZE;
-            stream_sizes = std::vector<uint32_t>(num_bitplanes, 0);
+            stream_sizes = std::vector<uint64_t>(num_bitplanes, 0);
             // define fixed point type
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
             std::vector<uint8_t *> streams;
@@ -167,8 +173,9 @@ namespace MDR {
             for(int i=0; i<level_errors.size(); i++){
                 level_errors[i] = 0;
             }
+            level_max_errors = std::vector<double>(num_bitplanes + 1, 0);
             T_data const * data_pos = data;
-            for(int i=0; i<n - block_size; i+=block_size){
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 T_stream sign_bitplane = 0;
                 for(int j=0; j<block_size; j++){
                     T_data cur_data = *(data_pos++);
@@ -177,7 +184,7 @@ namespace MDR {
                     int64_t fix_point = (int64_t) shifted_data;
                     T_fp fp_data = sign ? -fix_point : +fix_point;
                     // compute level errors
-                    collect_level_errors(level_errors, fabs(shifted_data), num_bitplanes);
+                    collect_level_errors(level_errors, level_max_errors, fabs(shifted_data), num_bitplanes);
                     bool first_bit = true;
                     for(int k=num_bitplanes - 1; k>=0; k--){
                         uint8_t index = num_bitplanes - 1 - k;
@@ -192,7 +199,7 @@ namespace MDR {
             }
             // leftover
             {
-                int rest_size = n % block_size;
+                size_t rest_size = n % block_size;
                 if(rest_size == 0) rest_size = block_size;
                 for(int j=0; j<rest_size; j++){
                     T_data cur_data = *(data_pos++);
@@ -201,7 +208,7 @@ namespace MDR {
                     int64_t fix_point = (int64_t) shifted_data;
                     T_fp fp_data = sign ? -fix_point : +fix_point;
                     // compute level errors
-                    collect_level_errors(level_errors, fabs(shifted_data), num_bitplanes);
+                    collect_level_errors(level_errors, level_max_errors, fabs(shifted_data), num_bitplanes);
                     bool first_bit = true;
                     for(int k=num_bitplanes - 1; k>=0; k--){
                         uint8_t index = num_bitplanes - 1 - k;
@@ -221,11 +228,12 @@ namespace MDR {
             // translate level errors
             for(int i=0; i<level_errors.size(); i++){
                 level_errors[i] = ldexp(level_errors[i], 2*(- num_bitplanes + exp));
+                level_max_errors[i] = ldexp(level_max_errors[i], - num_bitplanes + exp);
             }
             return streams;
         }
 
-        T_data * decode(const std::vector<uint8_t const *>& streams, int32_t n, int exp, uint8_t num_bitplanes) {
+        T_data * decode(const std::vector<uint8_t const *>& streams, size_t n, int exp, uint8_t num_bitplanes) {
             const int32_t block_size = PER_BIT_BLOCK_SIZE;
             // define fixed point type
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
@@ -241,7 +249,7 @@ namespace MDR {
             }
             // decode
             T_data * data_pos = data;
-            for(int i=0; i<n - block_size; i+=block_size){
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 for(int j=0; j<block_size; j++){
                     T_fp fp_data = 0;
                     // decode each bit of the data for each level component
@@ -263,7 +271,7 @@ namespace MDR {
             }
             // leftover
             {
-                int rest_size = n % block_size;
+                size_t rest_size = n % block_size;
                 if(rest_size == 0) rest_size = block_size;
                 for(int j=0; j<rest_size; j++){
                     T_fp fp_data = 0;
@@ -287,7 +295,7 @@ namespace MDR {
             return data;
         }
 
-        T_data * progressive_decode(const std::vector<uint8_t const *>& streams, int32_t n, int exp, uint8_t starting_bitplane, uint8_t num_bitplanes, int level) {
+        T_data * progressive_decode(const std::vector<uint8_t const *>& streams, size_t n, int exp, uint8_t starting_bitplane, uint8_t num_bitplanes, int level) {
             const int32_t block_size = PER_BIT_BLOCK_SIZE;
             // define fixed point type
             using T_fp = typename std::conditional<std::is_same<T_data, double>::value, uint64_t, uint32_t>::type;
@@ -310,7 +318,7 @@ namespace MDR {
             const uint8_t ending_bitplane = starting_bitplane + num_bitplanes;
             // decode
             T_data * data_pos = data;
-            for(int i=0; i<n - block_size; i+=block_size){
+            for(size_t i=0; i + block_size < n; i+=block_size){
                 for(int j=0; j<block_size; j++){
                     T_fp fp_data = 0;
                     // decode each bit of the data for each level component
@@ -346,7 +354,7 @@ namespace MDR {
             }
             // leftover
             {
-                int rest_size = n % block_size;
+                size_t rest_size = n % block_size;
                 if(rest_size == 0) rest_size = block_size;
                 for(int j=0; j<rest_size; j++){
                     T_fp fp_data = 0;
@@ -385,16 +393,20 @@ namespace MDR {
             std::cout << "Per-bit bitplane encoder" << std::endl;
         }
     private:
-        inline void collect_level_errors(std::vector<double>& level_errors, float data, int num_bitplanes) const {
-            uint32_t fp_data = (uint32_t) data;
-            double mantissa = data - (uint32_t) data;
+        // data is the magnitude shifted by num_bitplanes (up to 64), so the integer part is kept in 64 bits
+        inline void collect_level_errors(std::vector<double>& level_errors, std::vector<double>& level_max_errors, T_data data, int num_bitplanes) const {
+            uint64_t fp_data = (uint64_t) data;
+            double mantissa = data - (T_data) fp_data;
             level_errors[num_bitplanes] += mantissa * mantissa;
+            level_max_errors[num_bitplanes] = std::max(level_max_errors[num_bitplanes], mantissa);
             for(int k=1; k<num_bitplanes; k++){
-                uint32_t mask = (1 << k) - 1;
+                uint64_t mask = ((uint64_t) 1 << k) - 1;
                 double diff = (double) (fp_data & mask) + mantissa;
                 level_errors[num_bitplanes - k] += diff * diff;
+                level_max_errors[num_bitplanes - k] = std::max(level_max_errors[num_bitplanes - k], diff);
             }
-            level_errors[0] += data * data;
+            level_errors[0] += (double) data * data;
+            level_max_errors[0] = std::max(level_max_errors[0], (double) data);
         }
         std::vector<std::vector<bool>> level_signs;
         std::vector<std::vector<bool>> sign_flags;
@@ -5,6 +5,8 @@
 
 namespace MDR {
     // max error collector: computing according to bit-plane definition
+    // every entry, including the untruncated level, carries a x4 margin (2 more bitplanes for negabinary)
+    // encoders record exact max errors at refactor time, which are used without the margin
     template<class T>
     class MaxErrorCollector : public concepts::ErrorCollectorInterface<T> {
     public:
@@ -15,8 +17,8 @@ namespace MDR {
             int level_exp = 0;
             frexp(max_level_error, &level_exp);
             std::vector<double> max_e = std::vector<double>(num_bitplanes + 1, 0);
-            max_e[0] = max_level_error;
-            double err = ldexp(1.0, level_exp - 1);
+            max_e[0] = 4 * max_level_error;
+            double err = ldexp(1.0, level_exp + 1);
             for(int i=1; i<max_e.size(); i++){
                 max_e[i] = err;
                 err /= 2;
@@ -2,6 +2,7 @@
 #define _MDR_SQUARED_ERROR_COLLECTOR_HPP
 
 #include "ErrorCollectorInterface.hpp"
+#include <cstring>
 
 namespace MDR {
     union FloatingInt32{
@@ -13,6 +14,9 @@ namespace MDR {
         uint64_t i;
     };
     // s-norm error collector: collecting sum of squared errors
+    // truncation errors are derived in closed form from mantissa and exponent: dropping mantissa bits 0..b of an
+    // element d exponents below the level gives (mantissa & (2^(b+1) - 1)) ulps at bitplane d + prec - b
+    // elements are bucketed by d so that every bucket is swept with one mask per b over vector lanes
     template<class T>
     class SquaredErrorCollector : public concepts::ErrorCollectorInterface<T> {
     public:
@@ -23,49 +27,124 @@ namespace MDR {
         std::vector<double> collect_level_error(T const * data, size_t n, int num_bitplanes, T max_level_error) const {
             int level_exp = 0;
             frexp(max_level_error, &level_exp);
-            const int prec = std::is_same<T, double>::value ? 52 : 23;
-            using FloatingInt = typename std::conditional<std::is_same<T, double>::value, FloatingInt64, FloatingInt32>::type;
             const int encode_prec = num_bitplanes;
-            std::vector<double> squared_error = std::vector<double>(num_bitplanes + 1, 0);
-            FloatingInt fi;
-            for(int i=0; i<n; i++){
-                if(data[i] == 0) continue;
-                int data_exp = 0;
-                frexp(data[i], &data_exp);
-                T val = data[i];
-                fi.f = val;
-                int exp_diff = level_exp - data_exp + prec - encode_prec;
-                // int exp_diff = level_exp - encode_prec - data_exp + prec + 1;
-                int index = encode_prec;
-                if(exp_diff > 0){
-                    // zeroing out unrecorded bitplanes
-                    for(int b=0; b<exp_diff; b++){
-                        fi.i &= ~(1u << b);            
-                    }
+            // sum of squared truncated mantissas, indexed by exponent distance d and highest dropped bit b
+            std::vector<double> mantissa_errors(encode_prec * prec, 0);
+            // x^2 of elements without recorded bits, indexed by the last such bitplane
+            std::vector<double> zero_errors(encode_prec + 1, 0);
+            // exact errors of subnormal elements
+            std::vector<double> subnormal_errors(encode_prec + 1, 0);
+            // mantissas of a chunk bucketed by d; zero and subnormal elements go to the extra bucket
+            std::vector<T_int> bucketed(chunk_size);
+            std::vector<int> exp_diffs(chunk_size);
+            std::vector<uint32_t> bucket_sizes(encode_prec + 2);
+            std::vector<uint32_t> bucket_offsets(encode_prec + 2);
+            for(size_t i=0; i<n; i+=chunk_size){
+                const uint32_t size = std::min((size_t) chunk_size, n - i);
+                std::fill(bucket_sizes.begin(), bucket_sizes.end(), 0);
+                for(uint32_t j=0; j<size; j++){
+                    T val = data[i + j];
+                    T_int bits = 0;
+                    memcpy(&bits, &val, sizeof(T));
+                    int biased_exp = (bits >> prec) & (2 * bias + 1);
+                    bool normal = biased_exp != 0;
+                    if(!normal && (val != 0)) collect_subnormal_error(val, level_exp, encode_prec, zero_errors, subnormal_errors);
+                    int d = std::min(std::max(level_exp - (biased_exp - bias + 1), 0), encode_prec);
+                    zero_errors[d] += normal ? (double) val * val : 0;
+                    exp_diffs[j] = normal ? d : encode_prec + 1;
+                    bucket_sizes[exp_diffs[j]] ++;
                 }
-                else{
-                    // skip padding 0s (no errors)
-                    index += exp_diff;
-                    exp_diff = 0;
+                uint32_t offset = 0;
+                for(int d=0; d<=encode_prec + 1; d++){
+                    bucket_offsets[d] = offset;
+                    offset += bucket_sizes[d];
                 }
-                if(index > 0){
-                    for(int b=exp_diff; b<prec; b++){
-                        // change b-th bit to 0
-                        fi.i &= ~(1u << b);
-                        squared_error[index] += (data[i] - fi.f)*(data[i] - fi.f);
-                        index --;
-                    }
-                    while(index >= 0){
-                        squared_error[index] += data[i] * data[i];
-                        index --;
-                    }
+                for(uint32_t j=0; j<size; j++){
+                    T_int bits = 0;
+                    memcpy(&bits, data + i + j, sizeof(T));
+                    bucketed[bucket_offsets[exp_diffs[j]] ++] = bits & mantissa_mask;
+                }
+                // bucket encode_prec has no recorded mantissa bits
+                for(int d=0; d<encode_prec; d++){
+                    if(bucket_sizes[d] == 0) continue;
+                    T_int const * mantissa = bucketed.data() + bucket_offsets[d] - bucket_sizes[d];
+                    accumulate_mantissa_errors(mantissa, bucket_sizes[d], std::max(d + prec - encode_prec, 0), mantissa_errors.data() + d * prec);
+                }
+            }
+            std::vector<double> squared_error = std::vector<double>(encode_prec + 1, 0);
+            for(int d=0; d<encode_prec; d++){
+                for(int b=std::max(d + prec - encode_prec, 0); b<prec; b++){
+                    squared_error[d + prec - b] += ldexp(mantissa_errors[d * prec + b], 2 * (level_exp - 1 - prec - d));
                 }
             }
+            double zero_error = 0;
+            for(int k=encode_prec; k>=0; k--){
+                zero_error += zero_errors[k];
+                squared_error[k] += zero_error + subnormal_errors[k];
+            }
             return squared_error;
         }
         void print() const {
             std::cout << "Squared error collector." << std::endl;
         }
+    private:
+        using T_int = typename std::conditional<std::is_same<T, double>::value, uint64_t, uint32_t>::type;
+        static constexpr int prec = std::is_same<T, double>::value ? 52 : 23;
+        static constexpr int bias = std::is_same<T, double>::value ? 1023 : 127;
+        static constexpr T_int mantissa_mask = ((T_int) 1 << prec) - 1;
+        // one 512-bit vector of elements
+        static constexpr int lanes = 64 / sizeof(T);
+        static constexpr uint32_t chunk_size = 2048;
+
+        // exact conversion of a masked mantissa; the 64-bit case avoids integer conversion instructions
+        static inline double mantissa_to_double(uint32_t mantissa){
+            return (double) (int32_t) mantissa;
+        }
+        static inline double mantissa_to_double(uint64_t mantissa){
+            uint64_t bits = mantissa | 0x4330000000000000ull;
+            double value = 0;
+            memcpy(&value, &bits, sizeof(double));
+            return value - 4503599627370496.0;
+        }
+        // add sum of (mantissa & (2^(b+1) - 1))^2 to errors[b] for b in [b_start, prec)
+        static void accumulate_mantissa_errors(T_int const * mantissa, uint32_t n, int b_start, double * errors){
+            for(int b=b_start; b<prec; b++){
+                const T_int mask = ((T_int) 2 << b) - 1;
+                double lane_errors[lanes] = {0};
+                uint32_t j = 0;
+                for(; j + lanes <= n; j += lanes){
+                    for(int l=0; l<lanes; l++){
+                        double low = mantissa_to_double(mantissa[j + l] & mask);
+                        lane_errors[l] += low * low;
+                    }
+                }
+                for(; j<n; j++){
+                    double low = mantissa_to_double(mantissa[j] & mask);
+                    lane_errors[0] += low * low;
+                }
+                double error = 0;
+                for(int l=0; l<lanes; l++){
+                    error += lane_errors[l];
+                }
+                errors[b] += error;
+            }
+        }
+
+        // subnormals have no implicit bit, so the ulp does not follow from the element exponent
+        void collect_subnormal_error(T val, int level_exp, int encode_prec, std::vector<double>& zero_errors, std::vector<double>& subnormal_errors) const {
+            int data_exp = 0;
+            frexp(val, &data_exp);
+            T_int bits = 0;
+            memcpy(&bits, &val, sizeof(T));
+            int d = std::max(level_exp - data_exp, 0);
+            zero_errors[std::min(d, encode_prec)] += (double) val * val;
+            const double ulp = ldexp(1.0, 1 - bias - prec);
+            for(int k=d + 1; k<=std::min(d + prec, encode_prec); k++){
+                int b = d + prec - k;
+                double error = (double) (bits & mantissa_mask & (((T_int) 2 << b) - 1)) * ulp;
+                subnormal_errors[k] += error * error;
+            }
+        }
     };
 }
 #endif
@@ -19,6 +19,11 @@ namespace MDR {
 
             virtual inline T estimate_error_gain(T base, T current_level_err, T next_level_err, int level) const = 0;
 
+            // translate the requested tolerance to a bound on the accumulated estimated error
+            virtual double translate_tolerance(double tolerance) const {
+                return tolerance;
+            }
+
             virtual void print() const = 0;
         };
     }
@@ -27,7 +27,6 @@ namespace MDR {
                     std::cerr << num_dims << "-Dimentional error estimation not implemented." << std::endl;
                     exit(-1);
             }
-	    c *= 4; // 2 more bitplane for negabinary
         }
         MaxErrorEstimatorOB() : MaxErrorEstimatorOB(1) {}
 
@@ -47,6 +46,48 @@ namespace MDR {
         // derived constant
         T c = 0;
     };
+    // max error relative to the value range for orthogonal basis
+    template<class T>
+    class RelativeMaxErrorEstimatorOB : public MaxErrorEstimatorOB<T> {
+    public:
+        RelativeMaxErrorEstimatorOB(int num_dims, T value_range) : MaxErrorEstimatorOB<T>(num_dims), value_range(value_range) {}
+        RelativeMaxErrorEstimatorOB() : RelativeMaxErrorEstimatorOB(1, 1) {}
+        double translate_tolerance(double tolerance) const {
+            return tolerance * value_range;
+        }
+        void print() const {
+            std::cout << "Relative max error estimator (value range = " << value_range << ") for orthogonal basis." << std::endl;
+        }
+    private:
+        T value_range = 0;
+    };
+    // max error of a linear quantity of interest sum_c w_c * x_c, estimated on component c
+    // every component is retrieved to tolerance / num_components, so |w_c| scales its error
+    // for nonlinear quantities use bounds of |dQ/dx_c| as weights (1 for velocity magnitude)
+    template<class T>
+    class LinearQoIMaxErrorEstimatorOB : public MaxErrorEstimatorOB<T> {
+    public:
+        LinearQoIMaxErrorEstimatorOB(int num_dims, T weight, int num_components) : MaxErrorEstimatorOB<T>(num_dims), weight(fabs(weight)), num_components(num_components) {}
+        LinearQoIMaxErrorEstimatorOB() : LinearQoIMaxErrorEstimatorOB(1, 1, 1) {}
+        inline T estimate_error(T error, int level) const {
+            return weight * MaxErrorEstimatorOB<T>::estimate_error(error, level);
+        }
+        inline T estimate_error(T data, T reconstructed_data, int level) const {
+            return weight * MaxErrorEstimatorOB<T>::estimate_error(data, reconstructed_data, level);
+        }
+        inline T estimate_error_gain(T base, T current_level_err, T next_level_err, int level) const {
+            return weight * MaxErrorEstimatorOB<T>::estimate_error_gain(base, current_level_err, next_level_err, level);
+        }
+        double translate_tolerance(double tolerance) const {
+            return tolerance / num_components;
+        }
+        void print() const {
+            std::cout << "Linear QoI max error estimator (weight = " << weight << ", " << num_components << " components) for orthogonal basis." << std::endl;
+        }
+    private:
+        T weight = 1;
+        int num_components = 1;
+    };
     // max error estimator for hierarchical basis
     // c = 1 as all the operations are linear
     template<class T>
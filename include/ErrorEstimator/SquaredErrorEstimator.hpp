@@ -66,5 +66,23 @@ namespace MDR {
         T s = 0;
         std::vector<T> s_table;
     };
+
+    // PSNR target for orthogonal basis: PSNR = 20 log10(range) - 10 log10(sum of squared errors / num_elements)
+    template<class T>
+    class PSNRErrorEstimator : public SNormErrorEstimator<T> {
+    public:
+        PSNRErrorEstimator(int num_dims, int target_level, T value_range, size_t num_elements) : SNormErrorEstimator<T>(num_dims, target_level, 0), value_range(value_range), num_elements(num_elements) {}
+        PSNRErrorEstimator() : PSNRErrorEstimator(1, 0, 1, 1) {}
+        // tolerance is the requested PSNR in dB
+        double translate_tolerance(double tolerance) const {
+            return num_elements * (double) value_range * value_range * pow(10, - tolerance / 10);
+        }
+        void print() const {
+            std::cout << "PSNR error estimator (value range = " << value_range << ")." << std::endl;
+        }
+    private:
+        T value_range = 1;
+        size_t num_elements = 1;
+    };
 }
 #endif
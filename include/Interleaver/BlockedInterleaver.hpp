@@ -16,7 +16,7 @@ namespace MDR {
             size_t n1_coeff = dims_fine[0] - n1_nodal;
             size_t n2_coeff = dims_fine[1] - n2_nodal;
             size_t n3_coeff = dims_fine[2] - n3_nodal;
-            size_t dim0_offset = dims[1] * dims[2];
+            size_t dim0_offset = (size_t) dims[1] * dims[2];
             size_t dim1_offset = dims[2];
             const int block_size = 4;
             if(n1_nodal * n2_nodal * n3_nodal == 0){
@@ -47,7 +47,7 @@ namespace MDR {
             size_t n1_coeff = dims_fine[0] - n1_nodal;
             size_t n2_coeff = dims_fine[1] - n2_nodal;
             size_t n3_coeff = dims_fine[2] - n3_nodal;
-            size_t dim0_offset = dims[1] * dims[2];
+            size_t dim0_offset = (size_t) dims[1] * dims[2];
             size_t dim1_offset = dims[2];
             const int block_size = 4;
             if(n1_nodal * n2_nodal * n3_nodal == 0){
@@ -10,9 +10,9 @@ namespace MDR {
     public:
         DirectInterleaver(){}
         void interleave(T const * data, const std::vector<uint32_t>& dims, const std::vector<uint32_t>& dims_fine, const std::vector<uint32_t>& dims_coasre, T * buffer) const {
-            uint32_t dim0_offset = dims[1] * dims[2];
-            uint32_t dim1_offset = dims[2];
-            uint32_t count = 0;
+            size_t dim0_offset = (size_t) dims[1] * dims[2];
+            size_t dim1_offset = dims[2];
+            size_t count = 0;
             for(int i=0; i<dims_fine[0]; i++){
                 for(int j=0; j<dims_fine[1]; j++){
                     for(int k=0; k<dims_fine[2]; k++){
@@ -24,9 +24,9 @@ namespace MDR {
             }
         }
         void reposition(T const * buffer, const std::vector<uint32_t>& dims, const std::vector<uint32_t>& dims_fine, const std::vector<uint32_t>& dims_coasre, T * data) const {
-            uint32_t dim0_offset = dims[1] * dims[2];
-            uint32_t dim1_offset = dims[2];
-            uint32_t count = 0;
+            size_t dim0_offset = (size_t) dims[1] * dims[2];
+            size_t dim1_offset = dims[2];
+            size_t count = 0;
             for(int i=0; i<dims_fine[0]; i++){
                 for(int j=0; j<dims_fine[1]; j++){
                     for(int k=0; k<dims_fine[2]; k++){
@@ -16,7 +16,7 @@ namespace MDR {
             size_t n1_coeff = dims_fine[0] - n1_nodal;
             size_t n2_coeff = dims_fine[1] - n2_nodal;
             size_t n3_coeff = dims_fine[2] - n3_nodal;
-            size_t dim0_offset = dims[1] * dims[2];
+            size_t dim0_offset = (size_t) dims[1] * dims[2];
             size_t dim1_offset = dims[2];
             const int block_size = 1;
             if(n1_nodal * n2_nodal * n3_nodal == 0){
@@ -30,7 +30,7 @@ namespace MDR {
                 const T * coeff_nodal_coeff_pos = coeff_nodal_nodal_pos + n3_nodal;
                 const T * coeff_coeff_nodal_pos = coeff_nodal_nodal_pos + n2_nodal * dim1_offset;
                 const T * coeff_coeff_coeff_pos = coeff_coeff_nodal_pos + n3_nodal;
-                T * tmp_buffer = (T *) malloc(dims_fine[0] * dims_fine[1] * dims_fine[2] * sizeof(T));
+                T * tmp_buffer = (T *) malloc((size_t) dims_fine[0] * dims_fine[1] * dims_fine[2] * sizeof(T));
                 T * buffer_pos = tmp_buffer;
                 const T * pos[7];
                 pos[0] = buffer_pos;
@@ -59,7 +59,7 @@ namespace MDR {
             size_t n1_coeff = dims_fine[0] - n1_nodal;
             size_t n2_coeff = dims_fine[1] - n2_nodal;
             size_t n3_coeff = dims_fine[2] - n3_nodal;
-            size_t dim0_offset = dims[1] * dims[2];
+            size_t dim0_offset = (size_t) dims[1] * dims[2];
             size_t dim1_offset = dims[2];
             const int block_size = 1;
             if(n1_nodal * n2_nodal * n3_nodal == 0){
@@ -73,7 +73,7 @@ namespace MDR {
                 T * coeff_nodal_coeff_pos = coeff_nodal_nodal_pos + n3_nodal;
                 T * coeff_coeff_nodal_pos = coeff_nodal_nodal_pos + n2_nodal * dim1_offset;
                 T * coeff_coeff_coeff_pos = coeff_coeff_nodal_pos + n3_nodal;
-                T * tmp_buffer = (T *) malloc(dims_fine[0] * dims_fine[1] * dims_fine[2] * sizeof(T));        
+                T * tmp_buffer = (T *) malloc((size_t) dims_fine[0] * dims_fine[1] * dims_fine[2] * sizeof(T));        
                 T * pos[7];
                 pos[0] = tmp_buffer;
                 pos[1] = pos[0] + n1_nodal * n2_nodal * n3_coeff;
@@ -173,7 +173,7 @@ namespace MDR {
             3d 0-7 => 2-1-3-6-4-5-7
         */
         void skip_one_data_collection(const T * pos[7], T * buffer, size_t n1_nodal, size_t n1_coeff, size_t n2_nodal, size_t n2_coeff, size_t n3_nodal, size_t n3_coeff) const{
-            int index = 0;
+            size_t index = 0;
             for(int i=0; i<n1_coeff; i++){
                 for(int j=0; j<n2_coeff; j++){
                     for(int k=0; k<n3_coeff; k++){
@@ -240,7 +240,7 @@ namespace MDR {
             }    
         }        
         void skip_one_data_reposition(const T * buffer, T * pos[7], size_t n1_nodal, size_t n1_coeff, size_t n2_nodal, size_t n2_coeff, size_t n3_nodal, size_t n3_coeff) const{
-            int index = 0;
+            size_t index = 0;
             for(int i=0; i<n1_coeff; i++){
                 for(int j=0; j<n2_coeff; j++){
                     for(int k=0; k<n3_coeff; k++){
@@ -10,7 +10,7 @@ namespace MDR {
     class AdaptiveLevelCompressor : public concepts::LevelCompressorInterface {
     public:
         AdaptiveLevelCompressor(int l = 26) : latter_index(l) {}
-        uint8_t compress_level(std::vector<uint8_t*>& streams, std::vector<uint32_t>& stream_sizes) const {
+        uint8_t compress_level(std::vector<uint8_t*>& streams, std::vector<uint64_t>& stream_sizes) const {
             int stopping_index = stream_sizes.size();
             for(int i=0; i<streams.size(); i++){
                 uint8_t * compressed = NULL;
@@ -36,15 +36,52 @@ namespace MDR {
             }
             return stopping_index;
         }
-        void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint32_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index) {
+        void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index) {
             for(int i=0; i<num_bitplanes; i++){
                 int bitplane_index = starting_bitplane + i;
                 if((bitplane_index <= stopping_index) || (bitplane_index >= latter_index)){
-                    uint8_t * decompressed = NULL;
-                    auto decompressed_size = ZSTD::decompress(streams[i], stream_sizes[bitplane_index], &decompressed);
+                    uint8_t * decompressed = ZSTD::checked_decompress(streams[i], stream_sizes[bitplane_index]);
                     buffer.push_back(decompressed);
                     streams[i] = decompressed;                    
                 }
+                else if(!is_aligned(streams[i])){
+                    // raw bitplane at an unaligned offset of the retrieved buffer: copy it for the decoder
+                    uint8_t * copied = (uint8_t *) malloc(stream_sizes[bitplane_index]);
+                    memcpy(copied, streams[i], stream_sizes[bitplane_index]);
+                    buffer.push_back(copied);
+                    streams[i] = copied;
+                }
+            }
+        }
+        void decompress_level_to_arena(std::vector<const uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index, int level) {
+            // size the arena from the stream headers, keeping each bitplane 8-byte aligned for the decoder
+            // raw bitplanes are decoded in place unless they sit at an unaligned offset of the retrieved buffer
+            std::vector<uint64_t> decompressed_sizes(num_bitplanes, 0);
+            size_t arena_size = 0;
+            for(int i=0; i<num_bitplanes; i++){
+                int bitplane_index = starting_bitplane + i;
+                if((bitplane_index <= stopping_index) || (bitplane_index >= latter_index)){
+                    decompressed_sizes[i] = ZSTD::checked_decompressed_size(streams[i], stream_sizes[bitplane_index]);
+                    arena_size += (decompressed_sizes[i] + 7) & ~(size_t)7;
+                }
+                else if(!is_aligned(streams[i])){
+                    arena_size += (stream_sizes[bitplane_index] + 7) & ~(size_t)7;
+                }
+            }
+            if(arena.size() < arena_size) arena.resize(arena_size);
+            uint8_t * arena_pos = arena.data();
+            for(int i=0; i<num_bitplanes; i++){
+                int bitplane_index = starting_bitplane + i;
+                if((bitplane_index <= stopping_index) || (bitplane_index >= latter_index)){
+                    ZSTD::checked_decompress(streams[i], stream_sizes[bitplane_index], arena_pos, decompressed_sizes[i]);
+                    streams[i] = arena_pos;
+                    arena_pos += (decompressed_sizes[i] + 7) & ~(size_t)7;
+                }
+                else if(!is_aligned(streams[i])){
+                    memcpy(arena_pos, streams[i], stream_sizes[bitplane_index]);
+                    streams[i] = arena_pos;
+                    arena_pos += (stream_sizes[bitplane_index] + 7) & ~(size_t)7;
+                }
             }
         }
         void decompress_release(){
@@ -60,8 +97,14 @@ namespace MDR {
             decompress_release();
         }
     private:
+        // decoders read bitplanes as 8-byte words at most
+        static bool is_aligned(const uint8_t * stream){
+            return (reinterpret_cast<uintptr_t>(stream) & 7) == 0;
+        }
+
         int latter_index;
         std::vector<uint8_t*> buffer;
+        std::vector<uint8_t> arena;
     };
 }
 #endif
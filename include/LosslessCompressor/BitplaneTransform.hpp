@@ -0,0 +1,86 @@
+#ifndef _MDR_BITPLANE_TRANSFORM_HPP
+#define _MDR_BITPLANE_TRANSFORM_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace MDR {
+    // reversible transforms applied to raw bitplanes before lossless compression
+    namespace BitplaneTransform {
+        #define BITPLANE_TRANSFORM_NONE 0
+        // xor with the previous bitplane of the same level
+        #define BITPLANE_TRANSFORM_XOR_PREV 1
+        // group byte b of every word together
+        #define BITPLANE_TRANSFORM_BYTE_SHUFFLE 2
+        // transpose bits within blocks of (word bits) words
+        #define BITPLANE_TRANSFORM_BIT_SHUFFLE 3
+        #define BITPLANE_TRANSFORM_NUM 4
+
+        inline const char * name(uint8_t transform){
+            switch(transform){
+                case BITPLANE_TRANSFORM_NONE:
+                    return "none";
+                case BITPLANE_TRANSFORM_XOR_PREV:
+                    return "xor-prev";
+                case BITPLANE_TRANSFORM_BYTE_SHUFFLE:
+                    return "byte-shuffle";
+                case BITPLANE_TRANSFORM_BIT_SHUFFLE:
+                    return "bit-shuffle";
+                default:
+                    return "unknown";
+            }
+        }
+
+        inline void xor_bytes(uint8_t * data, uint8_t const * prev, size_t n){
+            for(size_t i=0; i<n; i++){
+                data[i] ^= prev[i];
+            }
+        }
+
+        // byte shuffle from data to out; trailing bytes that do not fill a word are copied
+        inline void byte_shuffle(uint8_t const * data, size_t n, int word_size, uint8_t * out){
+            size_t num_words = n / word_size;
+            for(int b=0; b<word_size; b++){
+                for(size_t i=0; i<num_words; i++){
+                    out[b * num_words + i] = data[i * word_size + b];
+                }
+            }
+            memcpy(out + num_words * word_size, data + num_words * word_size, n - num_words * word_size);
+        }
+        inline void byte_unshuffle(uint8_t const * data, size_t n, int word_size, uint8_t * out){
+            size_t num_words = n / word_size;
+            for(int b=0; b<word_size; b++){
+                for(size_t i=0; i<num_words; i++){
+                    out[i * word_size + b] = data[b * num_words + i];
+                }
+            }
+            memcpy(out + num_words * word_size, data + num_words * word_size, n - num_words * word_size);
+        }
+
+        // in-place transpose of the bit matrix formed by blocks of (word bits) words; self-inverse
+        // trailing words that do not fill a block are left unchanged
+        template<class T_word>
+        inline void bit_transpose(uint8_t * data, size_t n){
+            const int word_bits = sizeof(T_word) * 8;
+            const size_t block_bytes = word_bits * sizeof(T_word);
+            T_word block[word_bits];
+            for(size_t offset=0; offset + block_bytes <= n; offset += block_bytes){
+                T_word * words = reinterpret_cast<T_word*>(data + offset);
+                for(int b=0; b<word_bits; b++){
+                    T_word value = 0;
+                    for(int i=0; i<word_bits; i++){
+                        value |= ((words[i] >> b) & (T_word) 1) << i;
+                    }
+                    block[b] = value;
+                }
+                memcpy(words, block, block_bytes);
+            }
+        }
+        inline void bit_shuffle(uint8_t * data, size_t n, int word_size){
+            if(word_size == 8) bit_transpose<uint64_t>(data, n);
+            else bit_transpose<uint32_t>(data, n);
+        }
+    }
+}
+#endif
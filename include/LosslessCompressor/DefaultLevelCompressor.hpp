@@ -10,7 +10,7 @@ namespace MDR {
     class DefaultLevelCompressor : public concepts::LevelCompressorInterface {
     public:
         DefaultLevelCompressor(){}
-        uint8_t compress_level(std::vector<uint8_t*>& streams, std::vector<uint32_t>& stream_sizes) const {
+        uint8_t compress_level(std::vector<uint8_t*>& streams, std::vector<uint64_t>& stream_sizes) const {
             Timer timer;
             for(int i=0; i<streams.size(); i++){
                 uint8_t * compressed = NULL;
@@ -24,14 +24,29 @@ namespace MDR {
             timer.print("Lossless: ");
             return 0;
         }
-        void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint32_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index) {
+        void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index) {
             for(int i=0; i<num_bitplanes; i++){
-                uint8_t * decompressed = NULL;
-                auto decompressed_size = ZSTD::decompress(streams[i], stream_sizes[starting_bitplane + i], &decompressed);
+                uint8_t * decompressed = ZSTD::checked_decompress(streams[i], stream_sizes[starting_bitplane + i]);
                 buffer.push_back(decompressed);
                 streams[i] = decompressed;
             }
         }
+        void decompress_level_to_arena(std::vector<const uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index, int level) {
+            // size the arena from the stream headers, keeping each bitplane 8-byte aligned for the decoder
+            std::vector<uint64_t> decompressed_sizes(num_bitplanes, 0);
+            size_t arena_size = 0;
+            for(int i=0; i<num_bitplanes; i++){
+                decompressed_sizes[i] = ZSTD::checked_decompressed_size(streams[i], stream_sizes[starting_bitplane + i]);
+                arena_size += (decompressed_sizes[i] + 7) & ~(size_t)7;
+            }
+            if(arena.size() < arena_size) arena.resize(arena_size);
+            uint8_t * arena_pos = arena.data();
+            for(int i=0; i<num_bitplanes; i++){
+                ZSTD::checked_decompress(streams[i], stream_sizes[starting_bitplane + i], arena_pos, decompressed_sizes[i]);
+                streams[i] = arena_pos;
+                arena_pos += (decompressed_sizes[i] + 7) & ~(size_t)7;
+            }
+        }
         void decompress_release(){
             for(int i=0; i<buffer.size(); i++){
                 free(buffer[i]);
@@ -46,6 +61,7 @@ namespace MDR {
         }
     private:
         std::vector<uint8_t*> buffer;
+        std::vector<uint8_t> arena;
     };
 }
 #endif
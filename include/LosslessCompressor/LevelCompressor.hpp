@@ -4,5 +4,7 @@
 #include "DefaultLevelCompressor.hpp"
 #include "AdaptiveLevelCompressor.hpp"
 #include "NullLevelCompressor.hpp"
+#include "StreamingLevelCompressor.hpp"
+#include "TransformLevelCompressor.hpp"
 
 #endif
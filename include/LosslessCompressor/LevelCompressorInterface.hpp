@@ -11,10 +11,17 @@ namespace MDR {
             virtual ~LevelCompressorInterface() = default;
 
             // compress level, overwrite and free original streams; rewrite streams sizes
-            virtual uint8_t compress_level(std::vector<uint8_t*>& streams, std::vector<uint32_t>& stream_sizes) const = 0;
+            // the returned per-level tag is recorded in metadata and passed back as stopping_index
+            virtual uint8_t compress_level(std::vector<uint8_t*>& streams, std::vector<uint64_t>& stream_sizes) const = 0;
 
+            // input streams of the decompress functions are only read, so they may be views into retrieved buffers
             // decompress level, create new buffer and overwrite original streams; will not change stream sizes
-            virtual void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint32_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index) = 0;
+            virtual void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index) = 0;
+
+            // decompress level into a contiguous arena owned by the compressor and overwrite original streams; will not change stream sizes
+            // the arena is reused across levels and calls, so the streams are only valid until the next call
+            // level identifies the level for compressors that keep state across progressive calls
+            virtual void decompress_level_to_arena(std::vector<const uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index, int level) = 0;
 
             // release the buffer created
             virtual void decompress_release() = 0;
@@ -5,11 +5,15 @@
 
 namespace MDR {
     // Null lossless compressor
+    // zero-copy: encoded bitplanes are written as is and decoded from views into the retrieved buffers; every bitplane
+    // is a whole number of encoder words, so the views stay word aligned as long as every piece of the buffer is raw
+    // (buffers mixing compressed pieces, e.g. AdaptiveLevelCompressor output, need each piece padded to encoder words)
     class NullLevelCompressor : public concepts::LevelCompressorInterface {
     public:
         NullLevelCompressor(){}
-        uint8_t compress_level(std::vector<uint8_t*>& streams, std::vector<uint32_t>& stream_sizes) const { return 0;}
-        void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint32_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index){}
+        uint8_t compress_level(std::vector<uint8_t*>& streams, std::vector<uint64_t>& stream_sizes) const { return 0;}
+        void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index){}
+        void decompress_level_to_arena(std::vector<const uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index, int level){}
         void decompress_release(){}
         void print() const {
             std::cout << "Null level compressor" << std::endl;
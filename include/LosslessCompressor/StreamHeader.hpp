@@ -0,0 +1,90 @@
+#ifndef _MDR_STREAM_HEADER_HPP
+#define _MDR_STREAM_HEADER_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+namespace MDR {
+    // compact header in front of every losslessly compressed stream
+    /*
+        byte 0: version (bits 7-6) | codec id (bits 5-3) | flags (bits 2-0)
+        varint: raw (decompressed) size, LEB128 little-endian
+        optional: 4-byte little-endian checksum of the raw data (STREAM_FLAG_CHECKSUM)
+    */
+    namespace StreamHeader {
+        #define STREAM_HEADER_VERSION 1
+        #define STREAM_HEADER_MAX_SIZE (1 + 10 + 4)
+        // codec ids
+        #define STREAM_CODEC_STORED 0
+        #define STREAM_CODEC_ZSTD 1
+        // flags
+        #define STREAM_FLAG_CHECKSUM 0x1
+
+        struct Header{
+            uint8_t version = STREAM_HEADER_VERSION;
+            uint8_t codec = STREAM_CODEC_STORED;
+            uint8_t flags = 0;
+            uint64_t raw_size = 0;
+            uint32_t checksum = 0;
+        };
+
+        // FNV-1a checksum of the raw data; pass the previous value as seed to checksum data in pieces
+        inline uint32_t checksum(const uint8_t * data, size_t n, uint32_t seed = 2166136261u){
+            uint32_t hash = seed;
+            for(size_t i=0; i<n; i++){
+                hash ^= data[i];
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+
+        // write header and return number of bytes used
+        inline size_t write(const Header& header, uint8_t * buffer){
+            uint8_t * buffer_pos = buffer;
+            *(buffer_pos ++) = (uint8_t) (((header.version & 0x3) << 6) | ((header.codec & 0x7) << 3) | (header.flags & 0x7));
+            uint64_t value = header.raw_size;
+            do{
+                uint8_t byte = value & 0x7f;
+                value >>= 7;
+                if(value) byte |= 0x80;
+                *(buffer_pos ++) = byte;
+            } while(value);
+            if(header.flags & STREAM_FLAG_CHECKSUM){
+                for(int i=0; i<4; i++){
+                    *(buffer_pos ++) = (header.checksum >> (8 * i)) & 0xff;
+                }
+            }
+            return buffer_pos - buffer;
+        }
+
+        // parse header from at most n bytes; return number of bytes used or 0 if malformed
+        inline size_t read(const uint8_t * buffer, size_t n, Header& header){
+            if(n < 2) return 0;
+            const uint8_t * buffer_pos = buffer;
+            uint8_t descriptor = *(buffer_pos ++);
+            header.version = descriptor >> 6;
+            header.codec = (descriptor >> 3) & 0x7;
+            header.flags = descriptor & 0x7;
+            if(header.version != STREAM_HEADER_VERSION) return 0;
+            if((header.codec != STREAM_CODEC_STORED) && (header.codec != STREAM_CODEC_ZSTD)) return 0;
+            header.raw_size = 0;
+            int shift = 0;
+            while(true){
+                if((buffer_pos == buffer + n) || (shift > 63)) return 0;
+                uint8_t byte = *(buffer_pos ++);
+                header.raw_size |= (uint64_t) (byte & 0x7f) << shift;
+                if(!(byte & 0x80)) break;
+                shift += 7;
+            }
+            header.checksum = 0;
+            if(header.flags & STREAM_FLAG_CHECKSUM){
+                if(buffer + n - buffer_pos < 4) return 0;
+                for(int i=0; i<4; i++){
+                    header.checksum |= (uint32_t) *(buffer_pos ++) << (8 * i);
+                }
+            }
+            return buffer_pos - buffer;
+        }
+    }
+}
+#endif
@@ -0,0 +1,145 @@
+#ifndef _MDR_STREAMING_LEVEL_COMPRESSOR_HPP
+#define _MDR_STREAMING_LEVEL_COMPRESSOR_HPP
+
+#include "DefaultLevelCompressor.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+namespace MDR {
+    // compress bitplanes while the encoder produces them: one ZSTD stream per bitplane fed chunk by chunk
+    // with num_threads > 0, chunks are double buffered and compressed by worker threads while the next chunk is encoded
+    // output streams share the format of DefaultLevelCompressor, which is used for decompression and whole-level compression
+    class StreamingLevelCompressor : public DefaultLevelCompressor {
+    public:
+        StreamingLevelCompressor(int num_threads = 0, uint32_t chunk_size = 1 << 16) : num_threads(num_threads), chunk_size(chunk_size) {}
+
+        uint32_t get_chunk_size() const {
+            return chunk_size;
+        }
+
+        // start a level of num_bitplanes streams of stream_size raw bytes each
+        void begin_level(uint8_t num_bitplanes, uint64_t stream_size){
+            state = std::make_shared<LevelState>();
+            state->num_bitplanes = num_bitplanes;
+            state->compressors = std::vector<ZSTD::StreamCompressor>(num_bitplanes);
+            for(int i=0; i<num_bitplanes; i++){
+                state->compressors[i].begin(stream_size);
+            }
+            int num_slots = num_threads ? 2 : 1;
+            for(int s=0; s<num_slots; s++){
+                std::vector<uint8_t *> buffers;
+                for(int i=0; i<num_bitplanes; i++){
+                    buffers.push_back((uint8_t *) malloc(chunk_size));
+                }
+                state->slots.push_back(buffers);
+                state->slot_sizes.push_back(0);
+                state->slot_pending.push_back(0);
+            }
+            for(int t=0; t<num_threads; t++){
+                state->workers.push_back(std::thread(&StreamingLevelCompressor::work, state.get(), t, num_threads));
+            }
+        }
+
+        // buffers (one per bitplane, chunk_size bytes each) for the encoder to fill next
+        const std::vector<uint8_t *>& begin_chunk(){
+            LevelState& s = *state;
+            int slot = s.num_produced % s.slots.size();
+            if(num_threads){
+                std::unique_lock<std::mutex> lock(s.mutex);
+                s.cv.wait(lock, [&]{ return s.slot_pending[slot] == 0; });
+            }
+            return s.slots[slot];
+        }
+
+        // the first size bytes of each buffer from begin_chunk are ready
+        void end_chunk(uint32_t size){
+            LevelState& s = *state;
+            int slot = s.num_produced % s.slots.size();
+            if(num_threads){
+                std::lock_guard<std::mutex> lock(s.mutex);
+                s.slot_sizes[slot] = size;
+                s.slot_pending[slot] = num_threads;
+                s.num_produced ++;
+                s.cv.notify_all();
+            }
+            else{
+                for(int i=0; i<s.num_bitplanes; i++){
+                    s.compressors[i].append(s.slots[slot][i], size);
+                }
+                s.num_produced ++;
+            }
+        }
+
+        // wait for the pending chunks and return the compressed streams
+        std::vector<uint8_t *> end_level(std::vector<uint64_t>& stream_sizes){
+            LevelState& s = *state;
+            if(num_threads){
+                {
+                    std::lock_guard<std::mutex> lock(s.mutex);
+                    s.finished = true;
+                    s.cv.notify_all();
+                }
+                for(auto& worker:s.workers){
+                    worker.join();
+                }
+            }
+            std::vector<uint8_t *> streams(s.num_bitplanes, NULL);
+            stream_sizes = std::vector<uint64_t>(s.num_bitplanes, 0);
+            for(int i=0; i<s.num_bitplanes; i++){
+                stream_sizes[i] = s.compressors[i].end(&streams[i]);
+            }
+            for(auto& buffers:s.slots){
+                for(auto buffer:buffers) free(buffer);
+            }
+            state.reset();
+            return streams;
+        }
+
+        void print() const {
+            std::cout << "Streaming level lossless compressor (" << num_threads << " threads)" << std::endl;
+        }
+    private:
+        struct LevelState{
+            int num_bitplanes = 0;
+            std::vector<ZSTD::StreamCompressor> compressors;
+            std::vector<std::vector<uint8_t *>> slots;
+            std::vector<uint32_t> slot_sizes;
+            std::vector<int> slot_pending;
+            uint32_t num_produced = 0;
+            bool finished = false;
+            std::vector<std::thread> workers;
+            std::mutex mutex;
+            std::condition_variable cv;
+        };
+
+        // worker thread t compresses bitplanes t, t + num_threads, ... of every chunk in order
+        static void work(LevelState * state, int t, int num_threads){
+            LevelState& s = *state;
+            for(uint32_t chunk=0; ; chunk++){
+                int slot = chunk % s.slots.size();
+                uint32_t size = 0;
+                {
+                    std::unique_lock<std::mutex> lock(s.mutex);
+                    s.cv.wait(lock, [&]{ return (s.num_produced > chunk) || s.finished; });
+                    if(s.num_produced <= chunk) return;
+                    size = s.slot_sizes[slot];
+                }
+                for(int i=t; i<s.num_bitplanes; i+=num_threads){
+                    s.compressors[i].append(s.slots[slot][i], size);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(s.mutex);
+                    s.slot_pending[slot] --;
+                    s.cv.notify_all();
+                }
+            }
+        }
+
+        int num_threads;
+        uint32_t chunk_size;
+        std::shared_ptr<LevelState> state;
+    };
+}
+#endif
@@ -0,0 +1,169 @@
+#ifndef _MDR_TRANSFORM_LEVEL_COMPRESSOR_HPP
+#define _MDR_TRANSFORM_LEVEL_COMPRESSOR_HPP
+
+#include "DefaultLevelCompressor.hpp"
+#include "BitplaneTransform.hpp"
+
+namespace MDR {
+    // compress all layers after a reversible bitplane transform chosen per level by compressing a small probe
+    // the transform id (BITPLANE_TRANSFORM_*) is returned as the level tag, which the refactor records in metadata as the
+    // stopping index of the level; the decompress functions take it back as stopping_index
+    // xor-prev needs the raw previous bitplane, so resuming a level past bitplane 0 requires decompress_level_to_arena,
+    // which keeps it per level; decompress_level does not know the level and refuses to
+    class TransformLevelCompressor : public DefaultLevelCompressor {
+    public:
+        // word_size: size of the encoder stream integer type (4 or 8 bytes)
+        // transform: BITPLANE_TRANSFORM_* to use for every level, -1 to choose per level
+        TransformLevelCompressor(int word_size = 4, uint32_t probe_size = 1 << 14, int transform = -1) : word_size(word_size), probe_size(probe_size), transform(transform) {
+            if((word_size != 4) && (word_size != 8)){
+                std::cerr << "TransformLevelCompressor: word size " << word_size << " not supported." << std::endl;
+                exit(-1);
+            }
+        }
+        uint8_t compress_level(std::vector<uint8_t*>& streams, std::vector<uint64_t>& stream_sizes) const {
+            uint8_t transform = (this->transform >= 0) ? this->transform : probe(streams, stream_sizes);
+            if((transform == BITPLANE_TRANSFORM_XOR_PREV) && !xor_available(stream_sizes)){
+                transform = BITPLANE_TRANSFORM_NONE;
+            }
+            std::vector<uint8_t> scratch;
+            // backwards so that xor-prev sees the original previous bitplane
+            for(int i=streams.size() - 1; i>=0; i--){
+                forward(transform, streams[i], stream_sizes[i], (i > 0) ? streams[i - 1] : NULL, scratch);
+            }
+            for(int i=0; i<streams.size(); i++){
+                uint8_t * compressed = NULL;
+                auto compressed_size = ZSTD::compress(streams[i], stream_sizes[i], &compressed);
+                free(streams[i]);
+                streams[i] = compressed;
+                stream_sizes[i] = compressed_size;
+            }
+            return transform;
+        }
+        void decompress_level(std::vector<const uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index) {
+            if((stopping_index == BITPLANE_TRANSFORM_XOR_PREV) && (starting_bitplane > 0) && num_bitplanes){
+                std::cerr << "TransformLevelCompressor: xor-prev from bitplane " << +starting_bitplane << " needs the level, use decompress_level_to_arena." << std::endl;
+                exit(-1);
+            }
+            std::vector<const uint8_t*> compressed(streams);
+            DefaultLevelCompressor::decompress_level(streams, stream_sizes, starting_bitplane, num_bitplanes, stopping_index);
+            inverse(stopping_index, streams, compressed, stream_sizes, starting_bitplane, num_bitplanes, -1);
+        }
+        void decompress_level_to_arena(std::vector<const uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, uint8_t stopping_index, int level) {
+            std::vector<const uint8_t*> compressed(streams);
+            DefaultLevelCompressor::decompress_level_to_arena(streams, stream_sizes, starting_bitplane, num_bitplanes, stopping_index, level);
+            inverse(stopping_index, streams, compressed, stream_sizes, starting_bitplane, num_bitplanes, level);
+        }
+        // compressed probe bytes per transform, SIZE_MAX for transforms not available to the level
+        std::vector<size_t> probe_sizes(const std::vector<uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes) const {
+            const int num_bitplanes = streams.size();
+            const int num_samples = std::min(num_bitplanes, 4);
+            std::vector<size_t> sizes(BITPLANE_TRANSFORM_NUM, 0);
+            if(!xor_available(stream_sizes)) sizes[BITPLANE_TRANSFORM_XOR_PREV] = SIZE_MAX;
+            std::vector<uint8_t> sample;
+            std::vector<uint8_t> scratch;
+            std::vector<uint8_t> compressed(ZSTD_compressBound(probe_size));
+            for(int s=0; s<num_samples; s++){
+                // spread samples over the bitplanes after the first
+                int i = (num_bitplanes == 1) ? 0 : 1 + s * (num_bitplanes - 1) / num_samples;
+                uint64_t n = std::min<uint64_t>(stream_sizes[i], probe_size);
+                for(uint8_t t=0; t<BITPLANE_TRANSFORM_NUM; t++){
+                    if(sizes[t] == SIZE_MAX) continue;
+                    sample = std::vector<uint8_t>(streams[i], streams[i] + n);
+                    forward(t, sample.data(), n, (i > 0) ? streams[i - 1] : NULL, scratch);
+                    sizes[t] += ZSTD_compress(compressed.data(), compressed.size(), sample.data(), n, ZSTD_LEVEL);
+                }
+            }
+            return sizes;
+        }
+        void print() const {
+            std::cout << "Transform level lossless compressor" << std::endl;
+        }
+    private:
+        // xor-prev pairs each bitplane with the previous one, so it needs at least two bitplanes of the same size
+        static bool xor_available(const std::vector<uint64_t>& stream_sizes){
+            if(stream_sizes.size() < 2) return false;
+            for(int i=1; i<stream_sizes.size(); i++){
+                if(stream_sizes[i] != stream_sizes[0]) return false;
+            }
+            return true;
+        }
+        // compress a prefix of a few bitplanes with every transform and pick the smallest
+        uint8_t probe(const std::vector<uint8_t*>& streams, const std::vector<uint64_t>& stream_sizes) const {
+            std::vector<size_t> sizes = probe_sizes(streams, stream_sizes);
+            uint8_t transform = BITPLANE_TRANSFORM_NONE;
+            for(uint8_t t=0; t<BITPLANE_TRANSFORM_NUM; t++){
+                if(sizes[t] < sizes[transform]) transform = t;
+            }
+            return transform;
+        }
+        void forward(uint8_t transform, uint8_t * data, uint64_t n, uint8_t const * prev, std::vector<uint8_t>& scratch) const {
+            switch(transform){
+                case BITPLANE_TRANSFORM_XOR_PREV:
+                    if(prev) BitplaneTransform::xor_bytes(data, prev, n);
+                    break;
+                case BITPLANE_TRANSFORM_BYTE_SHUFFLE:
+                    if(scratch.size() < n) scratch.resize(n);
+                    BitplaneTransform::byte_shuffle(data, n, word_size, scratch.data());
+                    memcpy(data, scratch.data(), n);
+                    break;
+                case BITPLANE_TRANSFORM_BIT_SHUFFLE:
+                    BitplaneTransform::bit_shuffle(data, n, word_size);
+                    break;
+                default:
+                    break;
+            }
+        }
+        // undo the transform on decompressed streams (owned by this compressor)
+        void inverse(uint8_t transform, std::vector<const uint8_t*>& streams, const std::vector<const uint8_t*>& compressed, const std::vector<uint64_t>& stream_sizes, uint8_t starting_bitplane, uint8_t num_bitplanes, int level) {
+            if((transform == BITPLANE_TRANSFORM_NONE) || (num_bitplanes == 0)) return;
+            for(int i=0; i<num_bitplanes; i++){
+                uint8_t * data = const_cast<uint8_t*>(streams[i]);
+                uint64_t n = ZSTD::checked_decompressed_size(compressed[i], stream_sizes[starting_bitplane + i]);
+                switch(transform){
+                    case BITPLANE_TRANSFORM_XOR_PREV:
+                        if(i > 0){
+                            BitplaneTransform::xor_bytes(data, streams[i - 1], n);
+                        }
+                        else if(starting_bitplane > 0){
+                            // previous bitplane was decompressed in an earlier call
+                            if((level < 0) || (level >= last_bitplanes.size()) || (last_bitplane_indices[level] != starting_bitplane - 1) || (last_bitplanes[level].size() != n)){
+                                std::cerr << "TransformLevelCompressor: bitplane " << starting_bitplane - 1 << " of level " << level << " is required to undo xor-prev." << std::endl;
+                                exit(-1);
+                            }
+                            BitplaneTransform::xor_bytes(data, last_bitplanes[level].data(), n);
+                        }
+                        break;
+                    case BITPLANE_TRANSFORM_BYTE_SHUFFLE:
+                        if(scratch.size() < n) scratch.resize(n);
+                        BitplaneTransform::byte_unshuffle(data, n, word_size, scratch.data());
+                        memcpy(data, scratch.data(), n);
+                        break;
+                    case BITPLANE_TRANSFORM_BIT_SHUFFLE:
+                        BitplaneTransform::bit_shuffle(data, n, word_size);
+                        break;
+                    default:
+                        std::cerr << "TransformLevelCompressor: unknown transform " << +transform << std::endl;
+                        exit(-1);
+                }
+            }
+            // keep the last raw bitplane for the next progressive call
+            if((transform == BITPLANE_TRANSFORM_XOR_PREV) && (level >= 0)){
+                if(last_bitplanes.size() <= level){
+                    last_bitplanes.resize(level + 1);
+                    last_bitplane_indices.resize(level + 1, -1);
+                }
+                uint64_t n = ZSTD::checked_decompressed_size(compressed[num_bitplanes - 1], stream_sizes[starting_bitplane + num_bitplanes - 1]);
+                last_bitplanes[level] = std::vector<uint8_t>(streams[num_bitplanes - 1], streams[num_bitplanes - 1] + n);
+                last_bitplane_indices[level] = starting_bitplane + num_bitplanes - 1;
+            }
+        }
+
+        int word_size;
+        uint32_t probe_size;
+        int transform;
+        std::vector<uint8_t> scratch;
+        std::vector<std::vector<uint8_t>> last_bitplanes;
+        std::vector<int> last_bitplane_indices;
+    };
+}
+#endif
@@ -1,31 +1,229 @@
 #ifndef _MDR_ZSTD_HPP
 #define _MDR_ZSTD_HPP
 
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
 #include "zstd.h"
+#include "StreamHeader.hpp"
 
 namespace MDR {
     namespace ZSTD{
         #define ZSTD_LEVEL 3 //default setting of level is 3
         // ZSTD lossless compressor
-        uint32_t compress(uint8_t* data, uint32_t dataLength, uint8_t** compressBytes) {
-            uint32_t outSize = 0; 
-            size_t estimatedCompressedSize = 0;
-            if(dataLength < 100) 
-                estimatedCompressedSize = 200;
-            else
-                estimatedCompressedSize = dataLength*1.2;
-            *compressBytes = (uint8_t*)malloc(estimatedCompressedSize);
-            *reinterpret_cast<size_t*>(*compressBytes) = dataLength;
-            outSize = ZSTD_compress(*compressBytes + sizeof(size_t), estimatedCompressedSize, data, dataLength, ZSTD_LEVEL); 
-            return outSize + sizeof(size_t);
-        }
-        uint32_t decompress(const uint8_t* compressBytes, uint32_t cmpSize, uint8_t** oriData) {
-            uint32_t outSize = 0;
-            outSize = *reinterpret_cast<const size_t*>(compressBytes);
+        // streams are prefixed with a StreamHeader; incompressible data is stored as is
+        // streams with the older size_t prefix are still read
+        uint64_t compress(uint8_t* data, uint64_t dataLength, uint8_t** compressBytes, bool checksum=false) {
+            StreamHeader::Header header;
+            header.codec = STREAM_CODEC_ZSTD;
+            header.raw_size = dataLength;
+            if(checksum){
+                header.flags |= STREAM_FLAG_CHECKSUM;
+                header.checksum = StreamHeader::checksum(data, dataLength);
+            }
+            size_t estimatedCompressedSize = ZSTD_compressBound(dataLength);
+            *compressBytes = (uint8_t*)malloc(STREAM_HEADER_MAX_SIZE + estimatedCompressedSize);
+            // header size does not depend on codec id
+            size_t headerSize = StreamHeader::write(header, *compressBytes);
+            size_t outSize = ZSTD_compress(*compressBytes + headerSize, estimatedCompressedSize, data, dataLength, ZSTD_LEVEL);
+            if(ZSTD_isError(outSize) || (outSize >= dataLength)){
+                header.codec = STREAM_CODEC_STORED;
+                StreamHeader::write(header, *compressBytes);
+                memcpy(*compressBytes + headerSize, data, dataLength);
+                outSize = dataLength;
+            }
+            return headerSize + outSize;
+        }
+        // streams written before StreamHeader start with the raw size as a native size_t, followed by a ZSTD frame
+        // detected by the frame magic after the prefix and a frame content size equal to the prefix
+        bool is_legacy_stream(const uint8_t* compressBytes, uint64_t cmpSize, size_t& rawSize) {
+            if(cmpSize < sizeof(size_t) + 4) return false;
+            memcpy(&rawSize, compressBytes, sizeof(size_t));
+            // the frame magic is little-endian
+            const uint8_t * frame = compressBytes + sizeof(size_t);
+            uint32_t magic = frame[0] | (frame[1] << 8) | (frame[2] << 16) | ((uint32_t) frame[3] << 24);
+            if(magic != ZSTD_MAGICNUMBER) return false;
+            unsigned long long frameSize = ZSTD_getFrameContentSize(compressBytes + sizeof(size_t), cmpSize - sizeof(size_t));
+            return (frameSize != ZSTD_CONTENTSIZE_ERROR) && (frameSize != ZSTD_CONTENTSIZE_UNKNOWN) && (frameSize == rawSize);
+        }
+        // parse and validate the stream header against the payload
+        bool read_header(const uint8_t* compressBytes, uint64_t cmpSize, StreamHeader::Header& header, size_t& headerSize) {
+            size_t legacySize = 0;
+            if(is_legacy_stream(compressBytes, cmpSize, legacySize)){
+                header = StreamHeader::Header();
+                header.codec = STREAM_CODEC_ZSTD;
+                header.raw_size = legacySize;
+                headerSize = sizeof(size_t);
+                return true;
+            }
+            headerSize = StreamHeader::read(compressBytes, cmpSize, header);
+            if(headerSize == 0){
+                std::cerr << "ZSTD: malformed stream header" << std::endl;
+                return false;
+            }
+            // only reachable where size_t is narrower than the 64-bit header size
+            if constexpr(sizeof(size_t) < sizeof(uint64_t)){
+                if(header.raw_size > SIZE_MAX){
+                    std::cerr << "ZSTD: stream size " << header.raw_size << " exceeds addressable memory" << std::endl;
+                    return false;
+                }
+            }
+            size_t payloadSize = cmpSize - headerSize;
+            if(header.codec == STREAM_CODEC_STORED){
+                if(payloadSize != header.raw_size){
+                    std::cerr << "ZSTD: stored stream size " << payloadSize << " does not match header size " << header.raw_size << std::endl;
+                    return false;
+                }
+            }
+            else{
+                unsigned long long frameSize = ZSTD_getFrameContentSize(compressBytes + headerSize, payloadSize);
+                if((frameSize == ZSTD_CONTENTSIZE_ERROR) || (frameSize == ZSTD_CONTENTSIZE_UNKNOWN) || (frameSize != header.raw_size)){
+                    std::cerr << "ZSTD: frame size does not match header size " << header.raw_size << std::endl;
+                    return false;
+                }
+            }
+            return true;
+        }
+        // decompressed size recorded in the header, 0 if malformed
+        uint64_t get_decompressed_size(const uint8_t* compressBytes, uint64_t cmpSize) {
+            StreamHeader::Header header;
+            size_t headerSize = 0;
+            if(!read_header(compressBytes, cmpSize, header, headerSize)) return 0;
+            return header.raw_size;
+        }
+        // decompress into caller buffer of given capacity; return decompressed size, 0 if failed
+        uint64_t decompress(const uint8_t* compressBytes, uint64_t cmpSize, uint8_t* oriData, uint64_t capacity) {
+            StreamHeader::Header header;
+            size_t headerSize = 0;
+            if(!read_header(compressBytes, cmpSize, header, headerSize)) return 0;
+            if(header.raw_size > capacity){
+                std::cerr << "ZSTD: buffer of " << capacity << " bytes is too small for " << header.raw_size << " bytes" << std::endl;
+                return 0;
+            }
+            uint64_t outSize = header.raw_size;
+            if(header.codec == STREAM_CODEC_STORED){
+                memcpy(oriData, compressBytes + headerSize, outSize);
+            }
+            else{
+                size_t result = ZSTD_decompress(oriData, outSize, compressBytes + headerSize, cmpSize - headerSize);
+                if(ZSTD_isError(result) || (result != outSize)){
+                    std::cerr << "ZSTD: " << (ZSTD_isError(result) ? ZSTD_getErrorName(result) : "truncated frame") << std::endl;
+                    return 0;
+                }
+            }
+            if((header.flags & STREAM_FLAG_CHECKSUM) && (StreamHeader::checksum(oriData, outSize) != header.checksum)){
+                std::cerr << "ZSTD: checksum mismatch" << std::endl;
+                return 0;
+            }
+            return outSize;
+        }
+        // decompress into a new buffer sized from the header; *oriData is NULL if failed
+        uint64_t decompress(const uint8_t* compressBytes, uint64_t cmpSize, uint8_t** oriData) {
+            *oriData = NULL;
+            StreamHeader::Header header;
+            size_t headerSize = 0;
+            if(!read_header(compressBytes, cmpSize, header, headerSize)) return 0;
+            uint64_t outSize = header.raw_size;
             *oriData = (uint8_t*)malloc(outSize);
-            ZSTD_decompress(*oriData, outSize, compressBytes + sizeof(size_t), cmpSize - sizeof(size_t));
+            if(outSize && (decompress(compressBytes, cmpSize, *oriData, outSize) != outSize)){
+                free(*oriData);
+                *oriData = NULL;
+                return 0;
+            }
             return outSize;
         }
+        // decompressed size of a level stream; a malformed or truncated stream is fatal
+        uint64_t checked_decompressed_size(const uint8_t* compressBytes, uint64_t cmpSize) {
+            StreamHeader::Header header;
+            size_t headerSize = 0;
+            if(!read_header(compressBytes, cmpSize, header, headerSize)){
+                std::cerr << "ZSTD: cannot read level stream of " << cmpSize << " bytes" << std::endl;
+                exit(-1);
+            }
+            return header.raw_size;
+        }
+        // decompress a level stream of known size into caller buffer; a corrupt or short stream is fatal
+        void checked_decompress(const uint8_t* compressBytes, uint64_t cmpSize, uint8_t* oriData, uint64_t size) {
+            if(decompress(compressBytes, cmpSize, oriData, size) != size){
+                std::cerr << "ZSTD: cannot decompress level stream of " << cmpSize << " bytes to " << size << " bytes" << std::endl;
+                exit(-1);
+            }
+        }
+        // decompress a level stream into a new buffer; a corrupt or short stream is fatal
+        uint8_t * checked_decompress(const uint8_t* compressBytes, uint64_t cmpSize) {
+            uint64_t size = checked_decompressed_size(compressBytes, cmpSize);
+            uint8_t * oriData = (uint8_t*)malloc(size);
+            checked_decompress(compressBytes, cmpSize, oriData, size);
+            return oriData;
+        }
+        // ZSTD stream compressor: compress a stream of known raw size piece by piece
+        // produces the same format as compress() with the ZSTD codec
+        class StreamCompressor {
+        public:
+            StreamCompressor(){}
+            StreamCompressor(const StreamCompressor&) = delete;
+            StreamCompressor& operator=(const StreamCompressor&) = delete;
+            void begin(uint64_t raw_size, bool checksum=false){
+                if(!cctx) cctx = ZSTD_createCCtx();
+                ZSTD_CCtx_reset(cctx, ZSTD_reset_session_only);
+                ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, ZSTD_LEVEL);
+                ZSTD_CCtx_setPledgedSrcSize(cctx, raw_size);
+                header = StreamHeader::Header();
+                header.codec = STREAM_CODEC_ZSTD;
+                header.raw_size = raw_size;
+                if(checksum){
+                    header.flags |= STREAM_FLAG_CHECKSUM;
+                    header.checksum = StreamHeader::checksum(NULL, 0);
+                }
+                capacity = STREAM_HEADER_MAX_SIZE + ZSTD_CStreamOutSize();
+                buffer = (uint8_t *) malloc(capacity);
+                size = StreamHeader::write(header, buffer);
+            }
+            void append(const uint8_t * data, size_t n){
+                if(header.flags & STREAM_FLAG_CHECKSUM){
+                    header.checksum = StreamHeader::checksum(data, n, header.checksum);
+                }
+                ZSTD_inBuffer input = {data, n, 0};
+                while(input.pos < input.size){
+                    compress_step(input, ZSTD_e_continue);
+                }
+            }
+            // finish the frame and hand over the compressed stream
+            uint64_t end(uint8_t ** compressBytes){
+                ZSTD_inBuffer input = {NULL, 0, 0};
+                while(compress_step(input, ZSTD_e_end));
+                // rewrite header with the final checksum; size is unchanged
+                StreamHeader::write(header, buffer);
+                *compressBytes = buffer;
+                buffer = NULL;
+                return size;
+            }
+            ~StreamCompressor(){
+                if(buffer) free(buffer);
+                if(cctx) ZSTD_freeCCtx(cctx);
+            }
+        private:
+            // run one compression step with at least one ZSTD block of free output; return remaining bytes to flush
+            size_t compress_step(ZSTD_inBuffer& input, ZSTD_EndDirective mode){
+                if(capacity - size < ZSTD_CStreamOutSize()){
+                    capacity = 2 * capacity;
+                    buffer = (uint8_t *) realloc(buffer, capacity);
+                }
+                ZSTD_outBuffer output = {buffer + size, capacity - size, 0};
+                size_t remaining = ZSTD_compressStream2(cctx, &output, &input, mode);
+                if(ZSTD_isError(remaining)){
+                    std::cerr << "ZSTD: " << ZSTD_getErrorName(remaining) << std::endl;
+                    exit(-1);
+                }
+                size += output.pos;
+                return remaining;
+            }
+            ZSTD_CCtx * cctx = NULL;
+            StreamHeader::Header header;
+            uint8_t * buffer = NULL;
+            size_t capacity = 0;
+            size_t size = 0;
+        };
     }
 }
 #endif
@@ -11,46 +11,53 @@
 #include "SizeInterpreter/SizeInterpreter.hpp"
 #include "LosslessCompressor/LevelCompressor.hpp"
 #include "RefactorUtils.hpp"
+#include <functional>
 
 namespace MDR {
     // a decomposition-based scientific data reconstructor: inverse operator of composed refactor
     template<class T, class Decomposer, class Interleaver, class Encoder, class Compressor, class SizeInterpreter, class ErrorEstimator, class Retriever>
     class ComposedReconstructor : public concepts::ReconstructorInterface<T> {
     public:
+        // estimators plug in by deriving from the estimator of the level errors they consume
+        // and translating the requested tolerance (e.g. PSNR, relative bound) in translate_tolerance
         ComposedReconstructor(Decomposer decomposer, Interleaver interleaver, Encoder encoder, Compressor compressor, SizeInterpreter interpreter, Retriever retriever)
-            : decomposer(decomposer), interleaver(interleaver), encoder(encoder), compressor(compressor), interpreter(interpreter), retriever(retriever){}
+            : decomposer(decomposer), interleaver(interleaver), encoder(encoder), compressor(compressor), interpreter(interpreter), retriever(retriever){
+            static_assert(std::is_base_of<MaxErrorEstimator<T>, ErrorEstimator>::value || std::is_base_of<SquaredErrorEstimator<T>, ErrorEstimator>::value,
+                "ComposedReconstructor: error estimator must derive from MaxErrorEstimator or SquaredErrorEstimator.");
+        }
 
         // reconstruct data from encoded streams
         T * reconstruct(double tolerance){
             Timer timer;
+            stats.clear();
+            stats.tolerance = tolerance;
             timer.start();
             std::vector<std::vector<double>> level_abs_errors;
             uint8_t target_level = level_error_bounds.size() - 1;
-            std::vector<std::vector<double>>& level_errors = level_squared_errors;
-            if(std::is_base_of<MaxErrorEstimator<T>, ErrorEstimator>::value){
-                std::cout << "ErrorEstimator is base of MaxErrorEstimator, computing absolute error" << std::endl;
-                MaxErrorCollector<T> collector = MaxErrorCollector<T>();
-                for(int i=0; i<=target_level; i++){
-                    auto collected_error = collector.collect_level_error(NULL, 0, level_squared_errors[i].size(), level_error_bounds[i]);
-                    level_abs_errors.push_back(collected_error);
-                }
-                level_errors = level_abs_errors;
-            }
-            else if(std::is_base_of<SquaredErrorEstimator<T>, ErrorEstimator>::value){
-                std::cout << "ErrorEstimator is base of SquaredErrorEstimator, using level squared error directly" << std::endl;
-            }
-            else{
-                std::cerr << "Customized error estimator not supported yet" << std::endl;
-                exit(-1);
-            }
+            auto level_errors = select_level_errors(level_abs_errors);
             timer.end();
-            timer.print("Preprocessing");            
+            stats.add_stage("Preprocessing", timer.get());            
 
             timer.start();
             auto prev_level_num_bitplanes(level_num_bitplanes);
-            auto retrieve_sizes = interpreter.interpret_retrieve_size(level_sizes, level_errors, tolerance, level_num_bitplanes);
-            // retrieve data
-            level_components = retriever.retrieve_level_components(level_sizes, retrieve_sizes, prev_level_num_bitplanes, level_num_bitplanes);
+            auto retrieve_sizes = interpreter.interpret_retrieve_size(level_sizes, *level_errors, tolerance, level_num_bitplanes);
+            // retrieve data; a parallel retriever only issues the reads and levels are awaited when decoded
+            if constexpr(std::is_base_of<ParallelLevelFileRetriever, Retriever>::value){
+                level_components = retriever.issue_level_components(level_sizes, retrieve_sizes, prev_level_num_bitplanes, level_num_bitplanes);
+            }
+            else{
+                level_components = retriever.retrieve_level_components(level_sizes, retrieve_sizes, prev_level_num_bitplanes, level_num_bitplanes);
+            }
+            // prefetch what a tighter tolerance would ask for next while this retrieval is decoded
+            if constexpr(std::is_base_of<PrefetchLevelFileRetriever, Retriever>::value && std::is_base_of<IncrementalGreedyBasedSizeInterpreter<ErrorEstimator>, SizeInterpreter>::value){
+                retriever.prefetch(level_sizes, level_num_bitplanes, interpreter.predict_next(level_sizes, *level_errors, level_num_bitplanes, retriever.get_max_items(), retriever.get_max_bytes()));
+            }
+            stats.estimated_error = interpreter.get_estimated_error();
+            stats.level_bytes = std::vector<uint64_t>(retrieve_sizes.begin(), retrieve_sizes.end());
+            stats.level_num_bitplanes = level_num_bitplanes;
+            for(int i=0; i<level_num_bitplanes.size(); i++){
+                stats.plan_length += level_num_bitplanes[i] - prev_level_num_bitplanes[i];
+            }
             // check whether to reconstruct to full resolution
             int skipped_level = 0;
             for(int i=0; i<=target_level; i++){
@@ -62,7 +69,7 @@ namespace MDR {
             // TODO: uncomment skip level to reconstruct low resolution data
             // target_level -= skipped_level;
             timer.end();
-            timer.print("Interpret and retrieval");
+            stats.add_stage("Interpret and retrieval", timer.get());
 
             bool success = reconstruct(target_level, prev_level_num_bitplanes);
             retriever.release();
@@ -92,25 +99,109 @@ namespace MDR {
             return data.data();
         }
 
+        // reconstruct at several tolerances with one interpretation pass and one retrieval of the union
+        // plans are nested, so each fidelity only decodes the bitplanes added over the previous one
+        // emit(tolerance, data) is called loosest tolerance first; data stays valid until the next reconstruction
+        void progressive_reconstruct(const std::vector<double>& tolerances, const std::function<void(double, T const *)>& emit){
+            Timer timer;
+            stats.clear();
+            timer.start();
+            std::vector<std::vector<double>> level_abs_errors;
+            const uint8_t target_level = level_error_bounds.size() - 1;
+            auto level_errors = select_level_errors(level_abs_errors);
+            std::vector<double> sorted_tolerances(tolerances);
+            std::sort(sorted_tolerances.begin(), sorted_tolerances.end(), std::greater<double>());
+            timer.end();
+            stats.add_stage("Preprocessing", timer.get());
+
+            timer.start();
+            const auto start_level_num_bitplanes(level_num_bitplanes);
+            auto plans = interpret_retrieve_sizes(interpreter, level_sizes, *level_errors, sorted_tolerances, level_num_bitplanes);
+            std::vector<uint64_t> retrieve_sizes(level_sizes.size(), 0);
+            for(int i=0; i<level_sizes.size(); i++){
+                for(int j=start_level_num_bitplanes[i]; j<level_num_bitplanes[i]; j++){
+                    retrieve_sizes[i] += level_sizes[i][j];
+                }
+                stats.plan_length += level_num_bitplanes[i] - start_level_num_bitplanes[i];
+            }
+            // retrieve the union once
+            auto union_components = retriever.retrieve_level_components(level_sizes, retrieve_sizes, start_level_num_bitplanes, level_num_bitplanes);
+            stats.tolerance = sorted_tolerances.size() ? sorted_tolerances.back() : 0;
+            stats.estimated_error = interpreter.get_estimated_error();
+            stats.level_bytes = std::vector<uint64_t>(retrieve_sizes.begin(), retrieve_sizes.end());
+            stats.level_num_bitplanes = level_num_bitplanes;
+            timer.end();
+            stats.add_stage("Interpret and retrieval", timer.get());
+
+            auto prev_level_num_bitplanes(start_level_num_bitplanes);
+            for(int k=0; k<plans.size(); k++){
+                // components of the bitplanes this fidelity adds
+                level_components.clear();
+                for(int i=0; i<union_components.size(); i++){
+                    auto begin = union_components[i].begin() + (prev_level_num_bitplanes[i] - start_level_num_bitplanes[i]);
+                    level_components.push_back(std::vector<const uint8_t*>(begin, begin + (plans[k][i] - prev_level_num_bitplanes[i])));
+                }
+                level_num_bitplanes = plans[k];
+                std::vector<T> cur_data(data);
+                reconstruct(target_level, prev_level_num_bitplanes);
+                if(cur_data.size() == data.size()){
+                    for(int i=0; i<data.size(); i++){
+                        data[i] += cur_data[i];
+                    }
+                }
+                emit(sorted_tolerances[k], data.data());
+                prev_level_num_bitplanes = plans[k];
+            }
+            retriever.release();
+        }
+
         void load_metadata(){
             uint8_t * metadata = retriever.load_metadata();
             uint8_t const * metadata_pos = metadata;
             uint8_t num_dims = *(metadata_pos ++);
+            bool has_max_errors = num_dims & METADATA_FLAG_MAX_ERRORS;
+            bool has_retrieval_plan = num_dims & METADATA_FLAG_RETRIEVAL_PLAN;
+            bool has_wide_sizes = num_dims & METADATA_FLAG_WIDE_SIZES;
+            num_dims &= ~(METADATA_FLAG_MAX_ERRORS | METADATA_FLAG_RETRIEVAL_PLAN | METADATA_FLAG_WIDE_SIZES);
             deserialize(metadata_pos, num_dims, dimensions);
             uint8_t num_levels = *(metadata_pos ++);
             deserialize(metadata_pos, num_levels, level_error_bounds);
             deserialize(metadata_pos, num_levels, level_squared_errors);
-            deserialize(metadata_pos, num_levels, level_sizes);
+            if(has_wide_sizes) deserialize(metadata_pos, num_levels, level_sizes);
+            else deserialize_widened<uint32_t>(metadata_pos, num_levels, level_sizes);
             deserialize(metadata_pos, num_levels, stopping_indices);
             deserialize(metadata_pos, num_levels, level_num);
+            level_max_errors.clear();
+            if(has_max_errors) deserialize(metadata_pos, num_levels, level_max_errors);
+            retrieval_plan = RetrievalPlan();
+            if(has_retrieval_plan) retrieval_plan.deserialize(metadata_pos);
+            // the stored plan is in MaxErrorEstimatorOB units; other estimators let the interpreter build its own plan
+            if constexpr(std::is_base_of<PlanBasedSizeInterpreter<ErrorEstimator>, SizeInterpreter>::value && (std::is_same<MaxErrorEstimatorOB<T>, ErrorEstimator>::value || std::is_same<RelativeMaxErrorEstimatorOB<T>, ErrorEstimator>::value)){
+                if(retrieval_plan.size()) interpreter.set_retrieval_plan(retrieval_plan);
+            }
             level_num_bitplanes = std::vector<uint8_t>(num_levels, 0);
             free(metadata);
         }
 
+        // statistics of the last reconstruction
+        const RetrievalStats& get_stats() const {
+            return stats;
+        }
+
+        // e.g. for retriever statistics such as prefetch hits
+        const Retriever& get_retriever() const {
+            return retriever;
+        }
+
         const std::vector<uint32_t>& get_dimensions(){
             return dimensions;
         }
 
+        // plan recorded at refactor time (empty for older metadata); errors are in MaxErrorEstimatorOB units
+        const RetrievalPlan& get_retrieval_plan() const {
+            return retrieval_plan;
+        }
+
         ~ComposedReconstructor(){}
 
         void print() const {
@@ -122,46 +213,69 @@ namespace MDR {
             std::cout << "Retriever: "; retriever.print();
         }
     private:
+        // level errors consumed by the estimator; bounds derived from the level error bounds go to level_abs_errors
+        std::vector<std::vector<double>> const * select_level_errors(std::vector<std::vector<double>>& level_abs_errors) const {
+            if(std::is_base_of<MaxErrorEstimator<T>, ErrorEstimator>::value){
+                if(level_max_errors.size()){
+                    // recorded max errors
+                    return &level_max_errors;
+                }
+                // bound from the level error bounds
+                MaxErrorCollector<T> collector = MaxErrorCollector<T>();
+                for(int i=0; i<level_error_bounds.size(); i++){
+                    auto collected_error = collector.collect_level_error(NULL, 0, level_squared_errors[i].size(), level_error_bounds[i]);
+                    level_abs_errors.push_back(collected_error);
+                }
+                return &level_abs_errors;
+            }
+            return &level_squared_errors;
+        }
+
         bool reconstruct(uint8_t target_level, const std::vector<uint8_t>& prev_level_num_bitplanes, bool progressive=true){
             Timer timer;
             timer.start();
             auto level_dims = compute_level_dims(dimensions, target_level);
             auto reconstruct_dimensions = level_dims[target_level];
-            uint32_t num_elements = 1;
+            size_t num_elements = 1;
             for(const auto& dim:reconstruct_dimensions){
                 num_elements *= dim;
             }
             data.clear();
             data = std::vector<T>(num_elements, 0);
             timer.end();
-            timer.print("Reconstruct Preprocessing");            
+            stats.add_stage("Reconstruct Preprocessing", timer.get());            
 
             auto level_elements = compute_level_elements(level_dims, target_level);
             std::vector<uint32_t> dims_dummy(reconstruct_dimensions.size(), 0);
             for(int i=0; i<=target_level; i++){
+                if constexpr(std::is_base_of<ParallelLevelFileRetriever, Retriever>::value){
+                    timer.start();
+                    retriever.wait_level(i);
+                    timer.end();
+                    stats.add_stage("Wait", timer.get());
+                }
                 timer.start();
-                compressor.decompress_level(level_components[i], level_sizes[i], prev_level_num_bitplanes[i], level_num_bitplanes[i] - prev_level_num_bitplanes[i], stopping_indices[i]);
+                compressor.decompress_level_to_arena(level_components[i], level_sizes[i], prev_level_num_bitplanes[i], level_num_bitplanes[i] - prev_level_num_bitplanes[i], stopping_indices[i], i);
                 timer.end();
-                timer.print("Lossless");            
+                stats.add_stage("Lossless", timer.get());            
                 timer.start();
                 int level_exp = 0;
                 frexp(level_error_bounds[i], &level_exp);
                 auto level_decoded_data = encoder.progressive_decode(level_components[i], level_elements[i], level_exp, prev_level_num_bitplanes[i], level_num_bitplanes[i] - prev_level_num_bitplanes[i], i);
-                compressor.decompress_release();
                 timer.end();
-                timer.print("Decoding");            
+                stats.add_stage("Decoding", timer.get());            
 
                 timer.start();
                 const std::vector<uint32_t>& prev_dims = (i == 0) ? dims_dummy : level_dims[i - 1];
                 interleaver.reposition(level_decoded_data, reconstruct_dimensions, level_dims[i], prev_dims, data.data());
                 free(level_decoded_data);
                 timer.end();
-                timer.print("Reposition");            
+                stats.add_stage("Reposition", timer.get());            
             }
             timer.start();
             decomposer.recompose(data.data(), reconstruct_dimensions, target_level);
             timer.end();
-            timer.print("Recomposing");            
+            stats.add_stage("Recomposing", timer.get());            
             return true;
         }
 
@@ -177,9 +291,12 @@ namespace MDR {
         std::vector<uint8_t> level_num_bitplanes;
         std::vector<uint8_t> stopping_indices;
         std::vector<std::vector<const uint8_t*>> level_components;
-        std::vector<std::vector<uint32_t>> level_sizes;
+        std::vector<std::vector<uint64_t>> level_sizes;
         std::vector<uint32_t> level_num;
         std::vector<std::vector<double>> level_squared_errors;
+        std::vector<std::vector<double>> level_max_errors;
+        RetrievalPlan retrieval_plan;
+        RetrievalStats stats;
     };
 }
 #endif
@@ -6,6 +6,8 @@
 #include "Interleaver/Interleaver.hpp"
 #include "BitplaneEncoder/BitplaneEncoder.hpp"
 #include "ErrorCollector/ErrorCollector.hpp"
+#include "ErrorEstimator/ErrorEstimator.hpp"
+#include "SizeInterpreter/RetrievalPlan.hpp"
 #include "LosslessCompressor/LevelCompressor.hpp"
 #include "Writer/Writer.hpp"
 #include "RefactorUtils.hpp"
@@ -22,7 +24,7 @@ namespace MDR {
             Timer timer;
             timer.start();
             dimensions = dims;
-            uint32_t num_elements = 1;
+            size_t num_elements = 1;
             for(const auto& dim:dimensions){
                 num_elements *= dim;
             }
@@ -32,9 +34,17 @@ namespace MDR {
                 timer.end();
                 timer.print("Refactor");
                 timer.start();
-                level_num = writer.write_level_components(level_components, level_sizes);
-                timer.end();
-                timer.print("Write");                
+                if constexpr(std::is_base_of<WriteBehindLevelFileWriter, Writer>::value){
+                    // levels were queued as they were encoded
+                    level_num = writer.wait();
+                    timer.end();
+                    timer.print("Write wait");
+                }
+                else{
+                    level_num = writer.write_level_components(level_components, level_sizes);
+                    timer.end();
+                    timer.print("Write");
+                }
             }
 
             write_metadata();
@@ -46,12 +56,13 @@ namespace MDR {
         }
 
         void write_metadata() const {
-            uint32_t metadata_size = sizeof(uint8_t) + get_size(dimensions) // dimensions
+            uint64_t metadata_size = sizeof(uint8_t) + get_size(dimensions) // dimensions
                             + sizeof(uint8_t) + get_size(level_error_bounds) + get_size(level_squared_errors) + get_size(level_sizes) // level information
-                            + get_size(stopping_indices) + get_size(level_num);
+                            + get_size(stopping_indices) + get_size(level_num) + get_size(level_max_errors)
+                            + (retrieval_plan.size() ? retrieval_plan.get_size() : 0);
             uint8_t * metadata = (uint8_t *) malloc(metadata_size);
             uint8_t * metadata_pos = metadata;
-            *(metadata_pos ++) = (uint8_t) dimensions.size();
+            *(metadata_pos ++) = (uint8_t) dimensions.size() | METADATA_FLAG_MAX_ERRORS | METADATA_FLAG_WIDE_SIZES | (retrieval_plan.size() ? METADATA_FLAG_RETRIEVAL_PLAN : 0);
             serialize(dimensions, metadata_pos);
             *(metadata_pos ++) = (uint8_t) level_error_bounds.size();
             serialize(level_error_bounds, metadata_pos);
@@ -59,6 +70,8 @@ namespace MDR {
             serialize(level_sizes, metadata_pos);
             serialize(stopping_indices, metadata_pos);
             serialize(level_num, metadata_pos);
+            serialize(level_max_errors, metadata_pos);
+            if(retrieval_plan.size()) retrieval_plan.serialize(metadata_pos);
             writer.write_metadata(metadata, metadata_size);
             free(metadata);
         }
@@ -88,6 +101,7 @@ namespace MDR {
             // encode level by level
             level_error_bounds.clear();
             level_squared_errors.clear();
+            level_max_errors.clear();
             level_components.clear();
             level_sizes.clear();
             auto level_dims = compute_level_dims(dimensions, target_level);
@@ -112,24 +126,54 @@ namespace MDR {
                 timer.start();
                 int level_exp = 0;
                 frexp(level_max_error, &level_exp);
-                std::vector<uint32_t> stream_sizes;
+                std::vector<uint64_t> stream_sizes;
                 std::vector<double> level_sq_err;
-                auto streams = encoder.encode(buffer, level_elements[i], level_exp, num_bitplanes, stream_sizes, level_sq_err);
-                free(buffer);
+                std::vector<double> level_max_err;
+                std::vector<uint8_t*> streams;
+                uint8_t stopping_index = 0;
+                if constexpr(std::is_base_of<StreamingLevelCompressor, Compressor>::value){
+                    // encode and compress in one pass
+                    streams = encoder.encode_streaming(buffer, level_elements[i], level_exp, num_bitplanes, stream_sizes, level_sq_err, level_max_err, compressor);
+                    free(buffer);
+                    timer.end();
+                    timer.print("Encoding and lossless");
+                    timer.start();
+                }
+                else{
+                    streams = encoder.encode(buffer, level_elements[i], level_exp, num_bitplanes, stream_sizes, level_sq_err, level_max_err);
+                    free(buffer);
+                    timer.end();
+                    timer.print("Encoding");
+                    timer.start();
+                    // lossless compression
+                    stopping_index = compressor.compress_level(streams, stream_sizes);
+                }
                 level_squared_errors.push_back(level_sq_err);
-                timer.end();
-                timer.print("Encoding");
-                timer.start();
-                // lossless compression
-                uint8_t stopping_index = compressor.compress_level(streams, stream_sizes);
+                level_max_errors.push_back(level_max_err);
                 stopping_indices.push_back(stopping_index);
                 // record encoded level data and size
+                if constexpr(std::is_base_of<WriteBehindLevelFileWriter, Writer>::value){
+                    // hand the level to the writer, which frees the streams once written
+                    writer.write_level(i, streams, stream_sizes);
+                    streams.clear();
+                }
                 level_components.push_back(streams);
                 level_sizes.push_back(stream_sizes);
                 timer.end();
                 timer.print("Lossless time");
             }
             print_vec("level sizes", level_sizes);
+            // greedy L-inf ordering, so that readers answer tolerances without replanning
+            retrieval_plan = RetrievalPlan();
+            if(dimensions.size() <= 3){
+                retrieval_plan = RetrievalPlan(level_sizes, level_max_errors, MaxErrorEstimatorOB<T>(dimensions.size()));
+            }
+            if constexpr(std::is_base_of<PackedObjectWriter, Writer>::value || std::is_base_of<ProgressiveStreamWriter, Writer>::value){
+                // lay components out in the order they will be retrieved; beyond 3 dimensions, where no plan is stored,
+                // order by the hierarchical-basis estimator, whose gains differ from the OB ones by a constant factor only
+                if(retrieval_plan.size()) writer.set_retrieval_plan(retrieval_plan);
+                else writer.set_retrieval_plan(RetrievalPlan(level_sizes, level_max_errors, MaxErrorEstimatorHB<T>()));
+            }
             return true;
         }
 
@@ -144,9 +188,11 @@ namespace MDR {
         std::vector<T> level_error_bounds;
         std::vector<uint8_t> stopping_indices;
         std::vector<std::vector<uint8_t*>> level_components;
-        std::vector<std::vector<uint32_t>> level_sizes;
+        std::vector<std::vector<uint64_t>> level_sizes;
         std::vector<uint32_t> level_num;
         std::vector<std::vector<double>> level_squared_errors;
+        std::vector<std::vector<double>> level_max_errors;
+        RetrievalPlan retrieval_plan;
     };
 }
 #endif
@@ -5,6 +5,10 @@
 #include <vector>
 #include <cmath>
 #include <ctime>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <utility>
 
 namespace MDR {
 
@@ -38,17 +42,17 @@ namespace MDR {
         @params level_dims: dimensions for all levels
         @params target_level: the target decomposition level
     */
-    std::vector<uint32_t> compute_level_elements(const std::vector<std::vector<uint32_t>>& level_dims, int target_level){
+    std::vector<uint64_t> compute_level_elements(const std::vector<std::vector<uint32_t>>& level_dims, int target_level){
         assert(level_dims.size());
         uint8_t num_dims = level_dims[0].size();
-        std::vector<uint32_t> level_elements(level_dims.size());
+        std::vector<uint64_t> level_elements(level_dims.size());
         level_elements[0] = 1;
         for(int j=0; j<num_dims; j++){
             level_elements[0] *= level_dims[0][j];
         }
-        uint32_t pre_num_elements = level_elements[0];
+        uint64_t pre_num_elements = level_elements[0];
         for(int i=1; i<=target_level; i++){
-            uint32_t num_elements = 1;
+            uint64_t num_elements = 1;
             for(int j=0; j<num_dims; j++){
                 num_elements *= level_dims[i][j];
             }
@@ -66,9 +70,9 @@ namespace MDR {
     @params n: number of level data points
     */
     template <class T>
-    T compute_max_abs_value(const T * data, uint32_t n){
+    T compute_max_abs_value(const T * data, size_t n){
         T max_val = 0;
-        for(int i=0; i<n; i++){
+        for(size_t i=0; i<n; i++){
             T val = fabs(data[i]);
             if(val > max_val) max_val = val;
         }
@@ -77,18 +81,25 @@ namespace MDR {
 
     // Get size of vector
     template <class T>
-    inline uint32_t get_size(const std::vector<T>& vec){
+    inline uint64_t get_size(const std::vector<T>& vec){
         return vec.size() * sizeof(T);
     }
     template <class T>
-    uint32_t get_size(const std::vector<std::vector<T>>& vec){
-        uint32_t size = 0;
+    uint64_t get_size(const std::vector<std::vector<T>>& vec){
+        uint64_t size = 0;
         for(int i=0; i<vec.size(); i++){
             size += sizeof(uint32_t) + vec[i].size() * sizeof(T);
         }
         return size;
     }
 
+    // set on the dimension count byte of metadata that records per-bitplane max errors
+    #define METADATA_FLAG_MAX_ERRORS 0x80
+    // set on the dimension count byte of metadata that records a precomputed retrieval plan
+    #define METADATA_FLAG_RETRIEVAL_PLAN 0x40
+    // set on the dimension count byte of metadata that records 64-bit bitplane sizes; older metadata has 32-bit sizes
+    #define METADATA_FLAG_WIDE_SIZES 0x20
+
     // Serialize/deserialize vectors
     // Auto-increment buffer position
     template <class T>
@@ -123,6 +134,16 @@ namespace MDR {
             buffer_pos += num * sizeof(T);
         }
     }
+    // deserialize vectors stored with a narrower element type T_stored
+    template <class T_stored, class T>
+    void deserialize_widened(uint8_t const *& buffer_pos, uint32_t num_levels, std::vector<std::vector<T>>& vec){
+        std::vector<std::vector<T_stored>> stored_vec;
+        deserialize(buffer_pos, num_levels, stored_vec);
+        vec.clear();
+        for(const auto& level_vec:stored_vec){
+            vec.push_back(std::vector<T>(level_vec.begin(), level_vec.end()));
+        }
+    }
 
     // print vector
     template <class T>
@@ -169,5 +190,69 @@ namespace MDR {
         struct timespec start_time, end_time;
     };
 
+    // statistics of the last retrieval, kept instead of printing on the retrieval path
+    struct RetrievalStats{
+        double tolerance = 0;
+        double estimated_error = 0;
+        // number of bitplanes retrieved
+        uint32_t plan_length = 0;
+        std::vector<uint64_t> level_bytes;
+        std::vector<uint8_t> level_num_bitplanes;
+        // stage name and time in nanoseconds, in order of first occurrence
+        std::vector<std::pair<std::string, uint64_t>> stage_ns;
+
+        void clear(){
+            tolerance = 0;
+            estimated_error = 0;
+            plan_length = 0;
+            level_bytes.clear();
+            level_num_bitplanes.clear();
+            stage_ns.clear();
+        }
+        // accumulate seconds into a stage
+        void add_stage(const std::string& name, double seconds){
+            uint64_t ns = seconds * 1e9;
+            for(auto& stage:stage_ns){
+                if(stage.first == name){
+                    stage.second += ns;
+                    return;
+                }
+            }
+            stage_ns.push_back(std::make_pair(name, ns));
+        }
+        uint64_t total_bytes() const {
+            uint64_t bytes = 0;
+            for(const auto& b:level_bytes) bytes += b;
+            return bytes;
+        }
+        std::string to_json() const {
+            std::ostringstream json;
+            json.precision(17);
+            json << "{\"tolerance\": " << tolerance << ", \"estimated_error\": " << estimated_error;
+            json << ", \"plan_length\": " << plan_length << ", \"total_bytes\": " << total_bytes();
+            json << ", \"level_bytes\": [";
+            for(int i=0; i<level_bytes.size(); i++){
+                json << (i ? ", " : "") << level_bytes[i];
+            }
+            json << "], \"level_num_bitplanes\": [";
+            for(int i=0; i<level_num_bitplanes.size(); i++){
+                json << (i ? ", " : "") << +level_num_bitplanes[i];
+            }
+            json << "], \"stage_ns\": {";
+            for(int i=0; i<stage_ns.size(); i++){
+                json << (i ? ", " : "") << "\"" << stage_ns[i].first << "\": " << stage_ns[i].second;
+            }
+            json << "}}";
+            return json.str();
+        }
+        void print() const {
+            std::cout << "Requested tolerance = " << tolerance << ", estimated error = " << estimated_error << std::endl;
+            std::cout << "Retrieved " << plan_length << " bitplanes, " << total_bytes() << " bytes" << std::endl;
+            for(const auto& stage:stage_ns){
+                std::cout << stage.first << " time: " << stage.second * 1e-9 << "s" << std::endl;
+            }
+        }
+    };
+
 }
 #endif
@@ -8,7 +8,7 @@ namespace MDR {
     class InOrderReorganizer : public concepts::ReorganizerInterface {
     public:
         InOrderReorganizer(){}
-        uint8_t * reorganize(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint32_t>>& level_sizes, std::vector<uint8_t>& order, uint32_t& total_size) const {
+        uint8_t * reorganize(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes, std::vector<uint8_t>& order, uint64_t& total_size) const {
             const int num_levels = level_sizes.size();
             total_size = 0;
             for(int i=0; i<num_levels; i++){
@@ -35,7 +35,7 @@ namespace MDR {
     class RoundRobinReorganizer : public concepts::ReorganizerInterface {
     public:
         RoundRobinReorganizer(){}
-        uint8_t * reorganize(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint32_t>>& level_sizes, std::vector<uint8_t>& order, uint32_t& total_size) const {
+        uint8_t * reorganize(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes, std::vector<uint8_t>& order, uint64_t& total_size) const {
             const int num_levels = level_sizes.size();
             total_size = 0;
             for(int i=0; i<num_levels; i++){
@@ -0,0 +1,66 @@
+#ifndef _MDR_RD_REORGANIZER_HPP
+#define _MDR_RD_REORGANIZER_HPP
+
+#include "ReorganizerInterface.hpp"
+#include "SizeInterpreter/RetrievalPlan.hpp"
+#include <functional>
+
+namespace MDR {
+    // rate-distortion bit-plane placement: one progressive stream of all levels in the order of
+    // largest estimated error gain per byte, with the truncation-point table embedded in front
+    /*
+        stream: table size u64 | truncation-point table (a serialized RetrievalPlan) | components in plan order
+        entry k of the table gives the component, the bytes of components 0..k and the estimated error after them,
+        so any prefix of the components is the best answer the estimator knows for its size
+    */
+    // the order comes from set_retrieval_plan, or is built from the level errors given at construction
+    class RDReorganizer : public concepts::ReorganizerInterface {
+    public:
+        RDReorganizer(){}
+        template<class ErrorEstimator>
+        RDReorganizer(const std::vector<std::vector<double>>& level_errors, const ErrorEstimator& error_estimator, bool sign_exclude = true){
+            build_plan = [=](const std::vector<std::vector<uint64_t>>& level_sizes){
+                return RetrievalPlan(level_sizes, level_errors, error_estimator, sign_exclude);
+            };
+        }
+        void set_retrieval_plan(const RetrievalPlan& plan){
+            retrieval_plan = plan;
+        }
+        uint8_t * reorganize(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes, std::vector<uint8_t>& order, uint64_t& total_size) const {
+            if(!retrieval_plan.size() && build_plan) retrieval_plan = build_plan(level_sizes);
+            size_t num_components = 0;
+            for(int i=0; i<level_sizes.size(); i++){
+                num_components += level_sizes[i].size();
+            }
+            if(retrieval_plan.size() != num_components){
+                std::cerr << "RD reorganizer: the retrieval plan does not cover the components" << std::endl;
+                exit(-1);
+            }
+            uint64_t table_size = retrieval_plan.get_size();
+            total_size = sizeof(uint64_t) + table_size + (num_components ? retrieval_plan.get_cumulative_size(num_components - 1) : 0);
+            uint8_t * reorganized_data = (uint8_t *) malloc(total_size);
+            uint8_t * reorganized_data_pos = reorganized_data;
+            memcpy(reorganized_data_pos, &table_size, sizeof(uint64_t));
+            reorganized_data_pos += sizeof(uint64_t);
+            retrieval_plan.serialize(reorganized_data_pos);
+            for(size_t k=0; k<num_components; k++){
+                int i = retrieval_plan.get_level(k);
+                int j = retrieval_plan.get_bitplane(k);
+                order.push_back(i);
+                memcpy(reorganized_data_pos, level_components[i][j], level_sizes[i][j]);
+                reorganized_data_pos += level_sizes[i][j];
+            }
+            return reorganized_data;
+        }
+        const RetrievalPlan& get_retrieval_plan() const {
+            return retrieval_plan;
+        }
+        void print() const {
+            std::cout << "Rate-distortion reorganizer." << std::endl;
+        }
+    private:
+        mutable RetrievalPlan retrieval_plan;
+        std::function<RetrievalPlan(const std::vector<std::vector<uint64_t>>&)> build_plan;
+    };
+}
+#endif
@@ -2,5 +2,6 @@
 #define _MDR_REORGANIZER_HPP
 
 #include "BasicReorganizer.hpp"
+#include "RDReorganizer.hpp"
 
 #endif
@@ -0,0 +1,111 @@
+#ifndef _MDR_CACHED_FILE_RETRIEVER_HPP
+#define _MDR_CACHED_FILE_RETRIEVER_HPP
+
+#include "RetrieverInterface.hpp"
+#include "ParallelFileRetriever.hpp"
+#include "ComponentCache.hpp"
+#include <cstdio>
+
+namespace MDR {
+    // Data retriever for files through a component cache shared across reconstructors
+    // components found in the cache are served without touching storage; for each level the range
+    // from the first to the last missing component is read in one go and its components are cached
+    // dataset and variable name the data in the cache, so reconstructors of the same variable share its components
+    class CachedLevelFileRetriever : public concepts::RetrieverInterface {
+    public:
+        CachedLevelFileRetriever(const std::string& metadata_file, const std::vector<std::string>& level_files, const std::string& dataset, const std::string& variable, ComponentCache& cache = ComponentCache::global())
+            : metadata_file(metadata_file), level_files(level_files), dataset(dataset), variable(variable), cache(&cache) {}
+
+        std::vector<std::vector<const uint8_t*>> retrieve_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint64_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
+            assert(level_files.size() == retrieve_sizes.size());
+            release();
+            std::vector<std::vector<const uint8_t*>> level_components;
+            for(int i=0; i<level_files.size(); i++){
+                const int begin = prev_level_num_bitplanes[i];
+                const int end = level_num_bitplanes[i];
+                std::vector<ComponentCache::Component> components(end - begin);
+                int first_miss = end;
+                int last_miss = begin - 1;
+                for(int j=begin; j<end; j++){
+                    components[j - begin] = cache->get(key(i, j));
+                    if(!components[j - begin]){
+                        first_miss = std::min(first_miss, j);
+                        last_miss = j;
+                    }
+                }
+                if(first_miss <= last_miss){
+                    uint64_t offset = 0;
+                    for(int j=0; j<first_miss; j++){
+                        offset += level_sizes[i][j];
+                    }
+                    uint64_t size = 0;
+                    for(int j=first_miss; j<=last_miss; j++){
+                        size += level_sizes[i][j];
+                    }
+                    std::vector<uint8_t> buffer(size);
+                    read_file_range(level_files[i], offset, size, buffer.data());
+                    const uint8_t * pos = buffer.data();
+                    for(int j=first_miss; j<=last_miss; j++){
+                        if(!components[j - begin]){
+                            auto component = std::make_shared<const std::vector<uint8_t>>(pos, pos + level_sizes[i][j]);
+                            cache->put(key(i, j), component);
+                            components[j - begin] = component;
+                        }
+                        pos += level_sizes[i][j];
+                    }
+                }
+                std::vector<const uint8_t*> interleaved_level;
+                for(const auto& component:components){
+                    interleaved_level.push_back(component->data());
+                    held_components.push_back(component);
+                }
+                level_components.push_back(interleaved_level);
+            }
+            return level_components;
+        }
+
+        uint8_t * load_metadata() const {
+            FILE * file = fopen(metadata_file.c_str(), "r");
+            fseek(file, 0, SEEK_END);
+            size_t num_bytes = ftell(file);
+            rewind(file);
+            uint8_t * metadata = (uint8_t *) malloc(num_bytes);
+            fread(metadata, 1, num_bytes, file);
+            fclose(file);
+            return metadata;
+        }
+
+        ComponentCache& get_cache() const {
+            return *cache;
+        }
+
+        // drops this retriever's hold on the components; they stay in the cache
+        void release(){
+            held_components.clear();
+        }
+
+        ~CachedLevelFileRetriever(){}
+
+        void print() const {
+            std::cout << "Cached file retriever." << std::endl;
+        }
+    private:
+        ComponentKey key(int level, int bitplane) const {
+            ComponentKey component_key;
+            component_key.dataset = dataset;
+            component_key.variable = variable;
+            component_key.level = level;
+            component_key.bitplane = bitplane;
+            return component_key;
+        }
+
+        std::string metadata_file;
+        std::vector<std::string> level_files;
+        std::string dataset;
+        std::string variable;
+        ComponentCache * cache;
+        // components handed out by the last retrieval
+        std::vector<ComponentCache::Component> held_components;
+    };
+}
+#endif
@@ -0,0 +1,128 @@
+#ifndef _MDR_COMPONENT_CACHE_HPP
+#define _MDR_COMPONENT_CACHE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace MDR {
+    // (dataset, variable, level, bitplane) of a stored component
+    struct ComponentKey{
+        std::string dataset;
+        std::string variable;
+        uint8_t level = 0;
+        uint8_t bitplane = 0;
+        bool operator==(const ComponentKey& other) const {
+            return (level == other.level) && (bitplane == other.bitplane) && (variable == other.variable) && (dataset == other.dataset);
+        }
+    };
+
+    struct ComponentKeyHash{
+        size_t operator()(const ComponentKey& key) const {
+            size_t hash = std::hash<std::string>()(key.dataset);
+            hash ^= std::hash<std::string>()(key.variable) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+            hash ^= ((size_t) key.level << 8 | key.bitplane) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+            return hash;
+        }
+    };
+
+    struct ComponentCacheStats{
+        uint64_t hit_bytes = 0;
+        uint64_t miss_bytes = 0;
+        uint64_t evicted_bytes = 0;
+        double hit_rate() const {
+            return (hit_bytes + miss_bytes) ? (double) hit_bytes / (hit_bytes + miss_bytes) : 0;
+        }
+        void print() const {
+            std::cout << "Component cache: hit " << hit_bytes << " bytes, missed " << miss_bytes << " bytes, evicted " << evicted_bytes << " bytes, hit rate " << hit_rate() << std::endl;
+        }
+    };
+
+    // size-bounded LRU cache of stored components, safe to share between threads and reconstructors
+    // components are handed out as shared pointers, so an evicted component stays valid for the readers holding it
+    class ComponentCache {
+    public:
+        typedef std::shared_ptr<const std::vector<uint8_t>> Component;
+
+        ComponentCache(uint64_t capacity = 1ULL << 30) : capacity(capacity) {}
+
+        // the cache shared by the whole process
+        static ComponentCache& global(){
+            static ComponentCache cache;
+            return cache;
+        }
+
+        // cached component or NULL
+        Component get(const ComponentKey& key){
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = entries.find(key);
+            if(it == entries.end()) return NULL;
+            lru.splice(lru.begin(), lru, it->second);
+            stats.hit_bytes += it->second->second->size();
+            return it->second->second;
+        }
+
+        // record a miss and cache the component read for it; components larger than the capacity are not kept
+        void put(const ComponentKey& key, const Component& component){
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.miss_bytes += component->size();
+            if(component->size() > capacity) return;
+            auto it = entries.find(key);
+            if(it != entries.end()){
+                size -= it->second->second->size();
+                lru.erase(it->second);
+                entries.erase(it);
+            }
+            lru.push_front(std::make_pair(key, component));
+            entries[key] = lru.begin();
+            size += component->size();
+            evict(capacity);
+        }
+
+        void set_capacity(uint64_t new_capacity){
+            std::lock_guard<std::mutex> lock(mutex);
+            capacity = new_capacity;
+            evict(capacity);
+        }
+
+        void clear(){
+            std::lock_guard<std::mutex> lock(mutex);
+            evict(0);
+        }
+
+        uint64_t get_size(){
+            std::lock_guard<std::mutex> lock(mutex);
+            return size;
+        }
+
+        ComponentCacheStats get_stats(){
+            std::lock_guard<std::mutex> lock(mutex);
+            return stats;
+        }
+    private:
+        // drop least recently used components until at most target bytes are cached
+        void evict(uint64_t target){
+            while(size > target){
+                auto& entry = lru.back();
+                size -= entry.second->size();
+                stats.evicted_bytes += entry.second->size();
+                entries.erase(entry.first);
+                lru.pop_back();
+            }
+        }
+
+        std::mutex mutex;
+        uint64_t capacity;
+        uint64_t size = 0;
+        std::list<std::pair<ComponentKey, Component>> lru;
+        std::unordered_map<ComponentKey, std::list<std::pair<ComponentKey, Component>>::iterator, ComponentKeyHash> entries;
+        ComponentCacheStats stats;
+    };
+}
+#endif
@@ -0,0 +1,194 @@
+#ifndef _MDR_CONTAINER_FILE_RETRIEVER_HPP
+#define _MDR_CONTAINER_FILE_RETRIEVER_HPP
+
+#include "RetrieverInterface.hpp"
+#include "Writer/ContainerFormat.hpp"
+#include <memory>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace MDR {
+    // Data retriever for a self-indexed container written by ContainerFileWriter
+    // the container is opened once and its metadata and index come from one read of the tail
+    // (a second read only if the tail is larger than tail_size);
+    // a retrieval is one read per level of the planned bitplanes, checked against the index checksums if verify is set
+    // with direct_io the reads bypass the page cache: each is widened to the container alignment into an aligned buffer,
+    // falling back to buffered reads where the file system does not support O_DIRECT
+    class ContainerFileRetriever : public concepts::RetrieverInterface {
+    public:
+        ContainerFileRetriever(const std::string& filename, bool verify = false, uint64_t tail_size = 1 << 16, bool direct_io = false) : filename(filename), verify(verify) {
+            container = std::make_shared<Container>(filename, tail_size, direct_io);
+        }
+
+        std::vector<std::vector<const uint8_t*>> retrieve_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint64_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
+            const auto& level_entries = container->level_entries;
+            assert(level_entries.size() == retrieve_sizes.size());
+            release();
+            std::vector<std::vector<const uint8_t*>> level_components;
+            for(int i=0; i<level_entries.size(); i++){
+                std::vector<const uint8_t*> interleaved_level;
+                if(prev_level_num_bitplanes[i] == level_num_bitplanes[i]){
+                    level_components.push_back(interleaved_level);
+                    continue;
+                }
+                const auto& first = level_entries[i][prev_level_num_bitplanes[i]];
+                const auto& last = level_entries[i][level_num_bitplanes[i] - 1];
+                if(last.offset + last.size - first.offset != retrieve_sizes[i]){
+                    std::cerr << "Retrieval of level " << i << " does not match the index of " << filename << std::endl;
+                    exit(-1);
+                }
+                uint8_t * buffer = NULL;
+                const uint8_t * level_data = container->read_range(first.offset, retrieve_sizes[i], buffer);
+                concated_level_components.push_back(buffer);
+                for(int j=prev_level_num_bitplanes[i]; j<level_num_bitplanes[i]; j++){
+                    const auto& entry = level_entries[i][j];
+                    const uint8_t * pos = level_data + (entry.offset - first.offset);
+                    if(verify && (StreamHeader::checksum(pos, entry.size) != entry.checksum)){
+                        std::cerr << "Checksum mismatch for level " << i << " bitplane " << j << " of " << filename << std::endl;
+                        exit(-1);
+                    }
+                    interleaved_level.push_back(pos);
+                }
+                level_components.push_back(interleaved_level);
+            }
+            return level_components;
+        }
+
+        uint8_t * load_metadata() const {
+            uint8_t * metadata = (uint8_t *) malloc(container->metadata.size());
+            memcpy(metadata, container->metadata.data(), container->metadata.size());
+            return metadata;
+        }
+
+        // index entries of a level in bitplane order
+        const std::vector<ContainerFormat::Entry>& get_level_entries(int level) const {
+            return container->level_entries[level];
+        }
+
+        void release(){
+            for(int i=0; i<concated_level_components.size(); i++){
+                free(concated_level_components[i]);
+            }
+            concated_level_components.clear();
+        }
+
+        ~ContainerFileRetriever(){}
+
+        void print() const {
+            std::cout << "Container file retriever." << std::endl;
+        }
+    private:
+        // open container with its metadata and index, closed when the last owner goes
+        struct Container{
+            int fd = -1;
+            // -1 without direct I/O
+            int direct_fd = -1;
+            uint32_t alignment = CONTAINER_DEFAULT_ALIGNMENT;
+            std::vector<uint8_t> metadata;
+            std::vector<std::vector<ContainerFormat::Entry>> level_entries;
+            std::string filename;
+
+            Container(const std::string& filename, uint64_t tail_size, bool direct_io) : filename(filename) {
+                fd = open(filename.c_str(), O_RDONLY);
+                struct stat st;
+                if((fd < 0) || fstat(fd, &st)){
+                    std::cerr << "Cannot open container " << filename << std::endl;
+                    exit(-1);
+                }
+                uint64_t file_size = st.st_size;
+                if(file_size < CONTAINER_FOOTER_SIZE) malformed();
+                uint64_t tail_offset = file_size - std::min(std::max(tail_size, (uint64_t) CONTAINER_FOOTER_SIZE), file_size);
+                std::vector<uint8_t> tail(file_size - tail_offset);
+                read(tail_offset, tail.size(), tail.data());
+                ContainerFormat::Footer footer;
+                if(!ContainerFormat::read_footer(tail.data() + tail.size() - CONTAINER_FOOTER_SIZE, footer)) malformed();
+                uint64_t index_size = footer.num_entries * CONTAINER_ENTRY_SIZE;
+                if((footer.index_offset != footer.metadata_offset + footer.metadata_size) || (footer.index_offset + index_size + CONTAINER_FOOTER_SIZE != file_size)) malformed();
+                // read the rest of metadata and index if the tail did not cover them
+                if(footer.metadata_offset < tail_offset){
+                    std::vector<uint8_t> head(tail_offset - footer.metadata_offset);
+                    read(footer.metadata_offset, head.size(), head.data());
+                    tail.insert(tail.begin(), head.begin(), head.end());
+                    tail_offset = footer.metadata_offset;
+                }
+                const uint8_t * metadata_pos = tail.data() + (footer.metadata_offset - tail_offset);
+                const uint8_t * index_pos = metadata_pos + footer.metadata_size;
+                if(StreamHeader::checksum(index_pos, index_size) != footer.index_checksum) malformed();
+                metadata = std::vector<uint8_t>(metadata_pos, index_pos);
+                level_entries.resize(footer.num_levels);
+                for(const auto& entry:ContainerFormat::read_index(index_pos, footer.num_entries)){
+                    if(entry.level >= level_entries.size()){
+                        // containers recording the number of levels index only those levels
+                        if(footer.num_levels) malformed();
+                        level_entries.resize(entry.level + 1);
+                    }
+                    if(entry.bitplane != level_entries[entry.level].size()) malformed();
+                    level_entries[entry.level].push_back(entry);
+                }
+                alignment = footer.alignment;
+                // O_DIRECT needs at least sector alignment of offsets, sizes and buffers
+                if(direct_io && alignment && (alignment % 512 == 0)){
+                    direct_fd = open(filename.c_str(), O_RDONLY | O_DIRECT);
+                }
+            }
+
+            ~Container(){
+                if(fd >= 0) close(fd);
+                if(direct_fd >= 0) close(direct_fd);
+            }
+
+            // read a range into a new buffer, which the caller frees; returns the range within the buffer
+            const uint8_t * read_range(uint64_t offset, uint64_t size, uint8_t *& buffer) const {
+                if(direct_fd >= 0){
+                    uint64_t begin = offset / alignment * alignment;
+                    uint64_t end = ContainerFormat::align_up(offset + size, alignment);
+                    void * aligned = NULL;
+                    if(!posix_memalign(&aligned, alignment, end - begin)){
+                        buffer = (uint8_t *) aligned;
+                        if(read_direct(begin, end - begin, offset + size - begin, buffer)) return buffer + (offset - begin);
+                        free(buffer);
+                    }
+                }
+                buffer = (uint8_t *) malloc(size);
+                read(offset, size, buffer);
+                return buffer;
+            }
+
+            // aligned read that may stop short at the end of the file once needed bytes are in; false if direct I/O fails
+            bool read_direct(uint64_t offset, uint64_t size, uint64_t needed, uint8_t * buffer) const {
+                uint64_t read_bytes = 0;
+                while(read_bytes < needed){
+                    ssize_t n = pread(direct_fd, buffer + read_bytes, size - read_bytes, offset + read_bytes);
+                    if(n <= 0) return false;
+                    read_bytes += n;
+                }
+                return true;
+            }
+
+            void read(uint64_t offset, uint64_t size, uint8_t * buffer) const {
+                uint64_t read_bytes = 0;
+                while(read_bytes < size){
+                    ssize_t n = pread(fd, buffer + read_bytes, size - read_bytes, offset + read_bytes);
+                    if(n <= 0){
+                        std::cerr << "Errors in pread while retrieving from container " << filename << std::endl;
+                        exit(-1);
+                    }
+                    read_bytes += n;
+                }
+            }
+
+            void malformed() const {
+                std::cerr << "Malformed container " << filename << std::endl;
+                exit(-1);
+            }
+        };
+
+        std::string filename;
+        bool verify;
+        // shared so that copies of the retriever keep one open container
+        std::shared_ptr<Container> container;
+        std::vector<uint8_t*> concated_level_components;
+    };
+}
+#endif
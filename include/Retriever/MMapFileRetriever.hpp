@@ -0,0 +1,127 @@
+#ifndef _MDR_MMAP_FILE_RETRIEVER_HPP
+#define _MDR_MMAP_FILE_RETRIEVER_HPP
+
+#include "RetrieverInterface.hpp"
+#include <cstring>
+#include <memory>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace MDR {
+    // read-only mapping of a whole file, unmapped when the last owner goes
+    struct MappedFile{
+        uint8_t * data = NULL;
+        size_t size = 0;
+        MappedFile(const std::string& filename){
+            int fd = open(filename.c_str(), O_RDONLY);
+            struct stat st;
+            if((fd < 0) || fstat(fd, &st)){
+                std::cerr << "Cannot open file " << filename << " for mapping" << std::endl;
+                exit(-1);
+            }
+            size = st.st_size;
+            if(size){
+                void * addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(addr == MAP_FAILED){
+                    std::cerr << "Cannot map file " << filename << std::endl;
+                    exit(-1);
+                }
+                data = (uint8_t *) addr;
+            }
+            close(fd);
+        }
+        // owns the mapping: moved, never copied
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) : data(other.data), size(other.size) {
+            other.data = NULL;
+            other.size = 0;
+        }
+        MappedFile& operator=(MappedFile&& other){
+            if(this != &other){
+                if(data) munmap(data, size);
+                data = other.data;
+                size = other.size;
+                other.data = NULL;
+                other.size = 0;
+            }
+            return *this;
+        }
+        ~MappedFile(){
+            if(data) munmap(data, size);
+        }
+        // advise on the pages covering [offset, offset + length)
+        void advise(size_t offset, size_t length, int advice) const {
+            if(!data || (offset >= size) || !length) return;
+            static const size_t page_size = sysconf(_SC_PAGESIZE);
+            size_t begin = offset / page_size * page_size;
+            size_t end = std::min(offset + length, size);
+            madvise(data + begin, end - begin, advice);
+        }
+    };
+
+    // Data retriever for files through memory mapping
+    // each level file is mapped once on first retrieval and components point straight into the mapping,
+    // so progressive retrievals do no reads or copies beyond page faults
+    // the planned range is advised WILLNEED and the rest of the level SEQUENTIAL
+    class MMapLevelFileRetriever : public concepts::RetrieverInterface {
+    public:
+        MMapLevelFileRetriever(const std::string& metadata_file, const std::vector<std::string>& level_files) : metadata_file(metadata_file), level_files(level_files) {
+            offsets = std::vector<uint64_t>(level_files.size(), 0);
+        }
+
+        std::vector<std::vector<const uint8_t*>> retrieve_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint64_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
+            assert(offsets.size() == retrieve_sizes.size());
+            if(mapped_files.empty()){
+                for(int i=0; i<level_files.size(); i++){
+                    mapped_files.push_back(std::make_shared<MappedFile>(level_files[i]));
+                }
+            }
+            std::vector<std::vector<const uint8_t*>> level_components;
+            for(int i=0; i<level_files.size(); i++){
+                const MappedFile& file = *mapped_files[i];
+                if(offsets[i] + retrieve_sizes[i] > file.size){
+                    std::cerr << "Retrieving beyond the end of " << level_files[i] << std::endl;
+                    exit(-1);
+                }
+                file.advise(offsets[i], retrieve_sizes[i], MADV_WILLNEED);
+                file.advise(offsets[i] + retrieve_sizes[i], file.size, MADV_SEQUENTIAL);
+                const uint8_t * pos = file.data + offsets[i];
+                std::vector<const uint8_t*> interleaved_level;
+                for(int j=prev_level_num_bitplanes[i]; j<level_num_bitplanes[i]; j++){
+                    interleaved_level.push_back(pos);
+                    pos += level_sizes[i][j];
+                }
+                level_components.push_back(interleaved_level);
+                offsets[i] += retrieve_sizes[i];
+            }
+            return level_components;
+        }
+
+        // copy out of a mapping: the caller owns and frees the metadata
+        uint8_t * load_metadata() const {
+            MappedFile file(metadata_file);
+            uint8_t * metadata = (uint8_t *) malloc(file.size);
+            memcpy(metadata, file.data, file.size);
+            return metadata;
+        }
+
+        // components stay valid until the retriever goes; the mappings are kept for the next retrieval
+        void release(){}
+
+        ~MMapLevelFileRetriever(){}
+
+        void print() const {
+            std::cout << "Memory-mapped file retriever." << std::endl;
+        }
+    private:
+        std::vector<std::string> level_files;
+        std::string metadata_file;
+        std::vector<uint64_t> offsets;
+        // shared so that copies of the retriever keep the mappings alive
+        std::vector<std::shared_ptr<MappedFile>> mapped_files;
+    };
+}
+#endif
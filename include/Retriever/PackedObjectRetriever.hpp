@@ -0,0 +1,113 @@
+#ifndef _MDR_PACKED_OBJECT_RETRIEVER_HPP
+#define _MDR_PACKED_OBJECT_RETRIEVER_HPP
+
+#include "RetrieverInterface.hpp"
+#include "ParallelFileRetriever.hpp"
+#include "Writer/ObjectMap.hpp"
+#include <cstdio>
+#include <map>
+
+namespace MDR {
+    // Data retriever for objects written by PackedObjectWriter
+    // the object map comes from the end of the metadata; a retrieval fetches every object holding a requested
+    // component whole and slices the components out of it
+    // objects with components not retrieved yet are kept for the next progressive retrieval, the others go on release
+    class PackedObjectRetriever : public concepts::RetrieverInterface {
+    public:
+        PackedObjectRetriever(const std::string& metadata_file, const std::string& object_prefix) : metadata_file(metadata_file), object_prefix(object_prefix) {
+            uint8_t * metadata = load_metadata();
+            if(!object_map.deserialize_tail(metadata, metadata_size)){
+                std::cerr << "No object map in " << metadata_file << std::endl;
+                exit(-1);
+            }
+            free(metadata);
+            remaining_components = std::vector<uint32_t>(object_map.object_sizes.size(), 0);
+            for(const auto& level_locations:object_map.locations){
+                for(const auto& location:level_locations){
+                    remaining_components[location.object] ++;
+                }
+            }
+        }
+
+        std::vector<std::vector<const uint8_t*>> retrieve_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint64_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
+            assert(object_map.locations.size() == retrieve_sizes.size());
+            release();
+            std::vector<std::vector<const uint8_t*>> level_components;
+            for(int i=0; i<level_num_bitplanes.size(); i++){
+                std::vector<const uint8_t*> interleaved_level;
+                uint64_t level_size = 0;
+                for(int j=prev_level_num_bitplanes[i]; j<level_num_bitplanes[i]; j++){
+                    const auto& location = object_map.locations[i][j];
+                    interleaved_level.push_back(fetch_object(location.object) + location.offset);
+                    remaining_components[location.object] --;
+                    level_size += location.size;
+                }
+                if(level_size != retrieve_sizes[i]){
+                    std::cerr << "Retrieval of level " << i << " does not match the object map of " << metadata_file << std::endl;
+                    exit(-1);
+                }
+                level_components.push_back(interleaved_level);
+            }
+            return level_components;
+        }
+
+        uint8_t * load_metadata() const {
+            FILE * file = fopen(metadata_file.c_str(), "r");
+            fseek(file, 0, SEEK_END);
+            size_t num_bytes = ftell(file);
+            rewind(file);
+            uint8_t * metadata = (uint8_t *) malloc(num_bytes);
+            fread(metadata, 1, num_bytes, file);
+            fclose(file);
+            metadata_size = num_bytes;
+            return metadata;
+        }
+
+        const ObjectMap& get_object_map() const {
+            return object_map;
+        }
+
+        // bytes of objects fetched so far
+        uint64_t get_fetched_bytes() const {
+            return fetched_bytes;
+        }
+
+        // frees the objects whose components have all been retrieved
+        void release(){
+            for(auto it=objects.begin(); it!=objects.end();){
+                if(remaining_components[it->first] == 0){
+                    free(it->second);
+                    it = objects.erase(it);
+                }
+                else it ++;
+            }
+        }
+
+        ~PackedObjectRetriever(){}
+
+        void print() const {
+            std::cout << "Packed object retriever." << std::endl;
+        }
+    private:
+        const uint8_t * fetch_object(uint32_t object){
+            auto it = objects.find(object);
+            if(it != objects.end()) return it->second;
+            uint64_t size = object_map.object_sizes[object];
+            uint8_t * buffer = (uint8_t *) malloc(size);
+            read_file_range(object_prefix + "_" + std::to_string(object), 0, size, buffer);
+            fetched_bytes += size;
+            objects[object] = buffer;
+            return buffer;
+        }
+
+        std::string metadata_file;
+        std::string object_prefix;
+        mutable uint64_t metadata_size = 0;
+        ObjectMap object_map;
+        // fetched objects and the number of their components not retrieved yet
+        std::map<uint32_t, uint8_t*> objects;
+        std::vector<uint32_t> remaining_components;
+        uint64_t fetched_bytes = 0;
+    };
+}
+#endif
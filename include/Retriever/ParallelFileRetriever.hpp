@@ -0,0 +1,128 @@
+#ifndef _MDR_PARALLEL_FILE_RETRIEVER_HPP
+#define _MDR_PARALLEL_FILE_RETRIEVER_HPP
+
+#include "RetrieverInterface.hpp"
+#include <future>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace MDR {
+    // read size bytes at offset of a file into buffer; return the error, empty if the read succeeded
+    // safe to run on a worker thread, which must not exit the process
+    inline std::string try_read_file_range(const std::string& filename, uint64_t offset, uint64_t size, uint8_t * buffer){
+        if(!size) return std::string();
+        int fd = open(filename.c_str(), O_RDONLY);
+        if(fd < 0){
+            return "Cannot open file " + filename;
+        }
+        uint64_t read_bytes = 0;
+        while(read_bytes < size){
+            ssize_t n = pread(fd, buffer + read_bytes, size - read_bytes, offset + read_bytes);
+            if(n <= 0){
+                close(fd);
+                return "Errors in pread while retrieving from file " + filename;
+            }
+            read_bytes += n;
+        }
+        close(fd);
+        return std::string();
+    }
+
+    // read size bytes at offset of a file into buffer; a failed read is fatal
+    inline void read_file_range(const std::string& filename, uint64_t offset, uint64_t size, uint8_t * buffer){
+        std::string error = try_read_file_range(filename, offset, size, buffer);
+        if(!error.empty()){
+            std::cerr << error << std::endl;
+            exit(-1);
+        }
+    }
+
+    // Data retriever for files reading all levels concurrently
+    // retrieve_level_components waits for every level, paying the slowest read instead of the sum;
+    // issue_level_components returns as soon as the reads are issued and wait_level blocks until a level lands,
+    // so the reconstructor decodes finished levels while the others are still read
+    class ParallelLevelFileRetriever : public concepts::RetrieverInterface {
+    public:
+        ParallelLevelFileRetriever(const std::string& metadata_file, const std::vector<std::string>& level_files) : metadata_file(metadata_file), level_files(level_files) {
+            offsets = std::vector<uint64_t>(level_files.size(), 0);
+        }
+
+        std::vector<std::vector<const uint8_t*>> retrieve_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint64_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
+            auto level_components = issue_level_components(level_sizes, retrieve_sizes, prev_level_num_bitplanes, level_num_bitplanes);
+            for(int i=0; i<pending_reads.size(); i++){
+                wait_level(i);
+            }
+            return level_components;
+        }
+
+        // start reading every level and return the component positions; a level is valid after wait_level
+        std::vector<std::vector<const uint8_t*>> issue_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint64_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
+            assert(offsets.size() == retrieve_sizes.size());
+            release();
+            std::vector<std::vector<const uint8_t*>> level_components;
+            for(int i=0; i<level_files.size(); i++){
+                uint8_t * buffer = (uint8_t *) malloc(retrieve_sizes[i]);
+                concated_level_components.push_back(buffer);
+                pending_reads.push_back(std::async(std::launch::async, try_read_file_range, level_files[i], offsets[i], retrieve_sizes[i], buffer).share());
+                offsets[i] += retrieve_sizes[i];
+                const uint8_t * pos = buffer;
+                std::vector<const uint8_t*> interleaved_level;
+                for(int j=prev_level_num_bitplanes[i]; j<level_num_bitplanes[i]; j++){
+                    interleaved_level.push_back(pos);
+                    pos += level_sizes[i][j];
+                }
+                level_components.push_back(interleaved_level);
+            }
+            return level_components;
+        }
+
+        // a failed read is reported here, on the waiting thread, once the other reads have finished
+        void wait_level(int level){
+            if(level >= pending_reads.size()) return;
+            std::string error = pending_reads[level].get();
+            if(!error.empty()){
+                std::cerr << error << std::endl;
+                release();
+                exit(-1);
+            }
+        }
+
+        uint8_t * load_metadata() const {
+            FILE * file = fopen(metadata_file.c_str(), "r");
+            fseek(file, 0, SEEK_END);
+            size_t num_bytes = ftell(file);
+            rewind(file);
+            uint8_t * metadata = (uint8_t *) malloc(num_bytes);
+            fread(metadata, 1, num_bytes, file);
+            fclose(file);
+            return metadata;
+        }
+
+        void release(){
+            for(int i=0; i<pending_reads.size(); i++){
+                pending_reads[i].wait();
+            }
+            pending_reads.clear();
+            for(int i=0; i<concated_level_components.size(); i++){
+                free(concated_level_components[i]);
+            }
+            concated_level_components.clear();
+        }
+
+        ~ParallelLevelFileRetriever(){
+            release();
+        }
+
+        void print() const {
+            std::cout << "Parallel file retriever." << std::endl;
+        }
+    private:
+        std::vector<std::string> level_files;
+        std::string metadata_file;
+        std::vector<uint64_t> offsets;
+        std::vector<uint8_t*> concated_level_components;
+        // shared so that the retriever stays copyable
+        std::vector<std::shared_future<std::string>> pending_reads;
+    };
+}
+#endif
@@ -0,0 +1,179 @@
+#ifndef _MDR_PREFETCH_FILE_RETRIEVER_HPP
+#define _MDR_PREFETCH_FILE_RETRIEVER_HPP
+
+#include "RetrieverInterface.hpp"
+#include "ParallelFileRetriever.hpp"
+#include <chrono>
+#include <cstring>
+
+namespace MDR {
+    // hits and savings of speculative prefetching
+    struct PrefetchStats{
+        uint64_t hit_bytes = 0;
+        uint64_t miss_bytes = 0;
+        // prefetched but not asked for by the next retrieval
+        uint64_t wasted_bytes = 0;
+        // read time of the hit bytes not spent waiting
+        double saved_seconds = 0;
+        double hit_rate() const {
+            return (hit_bytes + miss_bytes) ? (double) hit_bytes / (hit_bytes + miss_bytes) : 0;
+        }
+        void print() const {
+            std::cout << "Prefetch: hit " << hit_bytes << " bytes, missed " << miss_bytes << " bytes, wasted " << wasted_bytes << " bytes, hit rate " << hit_rate() << ", saved " << saved_seconds << " s" << std::endl;
+        }
+    };
+
+    // Data retriever for files that prefetches the bitplanes predicted for the next progressive retrieval
+    // prefetch reads the predicted bitplanes in the background while the current ones are decoded;
+    // the next retrieval takes what it asks for from the prefetched bytes and reads the rest
+    // max_items and max_bytes bound each prediction
+    class PrefetchLevelFileRetriever : public concepts::RetrieverInterface {
+    public:
+        PrefetchLevelFileRetriever(const std::string& metadata_file, const std::vector<std::string>& level_files, int max_items = 8, uint64_t max_bytes = 64 << 20)
+            : metadata_file(metadata_file), level_files(level_files), max_items(max_items), max_bytes(max_bytes) {
+            offsets = std::vector<uint64_t>(level_files.size(), 0);
+            prefetches = std::vector<Prefetch>(level_files.size());
+        }
+
+        std::vector<std::vector<const uint8_t*>> retrieve_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint64_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
+            assert(offsets.size() == retrieve_sizes.size());
+            release();
+            std::vector<std::vector<const uint8_t*>> level_components;
+            for(int i=0; i<level_files.size(); i++){
+                uint8_t * buffer = (uint8_t *) malloc(retrieve_sizes[i]);
+                uint64_t hit = take_prefetch(i, retrieve_sizes[i], buffer);
+                read_file_range(level_files[i], offsets[i] + hit, retrieve_sizes[i] - hit, buffer + hit);
+                stats.miss_bytes += retrieve_sizes[i] - hit;
+                concated_level_components.push_back(buffer);
+                offsets[i] += retrieve_sizes[i];
+                const uint8_t * pos = buffer;
+                std::vector<const uint8_t*> interleaved_level;
+                for(int j=prev_level_num_bitplanes[i]; j<level_num_bitplanes[i]; j++){
+                    interleaved_level.push_back(pos);
+                    pos += level_sizes[i][j];
+                }
+                level_components.push_back(interleaved_level);
+            }
+            return level_components;
+        }
+
+        // start reading bitplanes [index, next_index) of every level, where index is the count retrieved so far
+        void prefetch(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint8_t>& index, const std::vector<uint8_t>& next_index){
+            for(int i=0; i<level_files.size(); i++){
+                discard_prefetch(i);
+                uint64_t size = 0;
+                for(int j=index[i]; j<next_index[i]; j++){
+                    size += level_sizes[i][j];
+                }
+                if(!size) continue;
+                Prefetch& p = prefetches[i];
+                p.buffer = (uint8_t *) malloc(size);
+                p.offset = offsets[i];
+                p.size = size;
+                p.read = std::async(std::launch::async, timed_read, level_files[i], p.offset, p.size, p.buffer).share();
+            }
+        }
+
+        int get_max_items() const {
+            return max_items;
+        }
+
+        uint64_t get_max_bytes() const {
+            return max_bytes;
+        }
+
+        const PrefetchStats& get_prefetch_stats() const {
+            return stats;
+        }
+
+        uint8_t * load_metadata() const {
+            FILE * file = fopen(metadata_file.c_str(), "r");
+            fseek(file, 0, SEEK_END);
+            size_t num_bytes = ftell(file);
+            rewind(file);
+            uint8_t * metadata = (uint8_t *) malloc(num_bytes);
+            fread(metadata, 1, num_bytes, file);
+            fclose(file);
+            return metadata;
+        }
+
+        // frees the retrieved components; prefetches stay for the next retrieval
+        void release(){
+            for(int i=0; i<concated_level_components.size(); i++){
+                free(concated_level_components[i]);
+            }
+            concated_level_components.clear();
+        }
+
+        ~PrefetchLevelFileRetriever(){
+            release();
+            for(int i=0; i<prefetches.size(); i++){
+                if(!prefetches[i].buffer) continue;
+                prefetches[i].read.wait();
+                free(prefetches[i].buffer);
+            }
+        }
+
+        void print() const {
+            std::cout << "Prefetching file retriever." << std::endl;
+        }
+    private:
+        struct Prefetch{
+            uint8_t * buffer = NULL;
+            uint64_t offset = 0;
+            uint64_t size = 0;
+            // seconds spent reading
+            std::shared_future<double> read;
+        };
+
+        // runs on a worker thread: a failed read returns -1 and is retried, and reported, by the synchronous read
+        static double timed_read(const std::string& filename, uint64_t offset, uint64_t size, uint8_t * buffer){
+            auto start = std::chrono::steady_clock::now();
+            if(!try_read_file_range(filename, offset, size, buffer).empty()) return -1;
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        // copy the prefetched prefix of the requested range into buffer and return its size
+        uint64_t take_prefetch(int i, uint64_t size, uint8_t * buffer){
+            Prefetch& p = prefetches[i];
+            if(!p.buffer || (p.offset != offsets[i])){
+                discard_prefetch(i);
+                return 0;
+            }
+            auto start = std::chrono::steady_clock::now();
+            double read_seconds = p.read.get();
+            double wait_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if(read_seconds < 0){
+                discard_prefetch(i);
+                return 0;
+            }
+            uint64_t hit = std::min(size, p.size);
+            memcpy(buffer, p.buffer, hit);
+            stats.hit_bytes += hit;
+            stats.saved_seconds += std::max(read_seconds * hit / p.size - wait_seconds, 0.0);
+            p.offset += hit;
+            p.size -= hit;
+            discard_prefetch(i);
+            return hit;
+        }
+
+        void discard_prefetch(int i){
+            Prefetch& p = prefetches[i];
+            if(!p.buffer) return;
+            p.read.wait();
+            stats.wasted_bytes += p.size;
+            free(p.buffer);
+            p = Prefetch();
+        }
+
+        std::vector<std::string> level_files;
+        std::string metadata_file;
+        std::vector<uint64_t> offsets;
+        std::vector<uint8_t*> concated_level_components;
+        std::vector<Prefetch> prefetches;
+        int max_items;
+        uint64_t max_bytes;
+        PrefetchStats stats;
+    };
+}
+#endif
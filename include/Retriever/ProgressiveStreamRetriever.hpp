@@ -0,0 +1,99 @@
+#ifndef _MDR_PROGRESSIVE_STREAM_RETRIEVER_HPP
+#define _MDR_PROGRESSIVE_STREAM_RETRIEVER_HPP
+
+#include "RetrieverInterface.hpp"
+#include "ParallelFileRetriever.hpp"
+#include "SizeInterpreter/RetrievalPlan.hpp"
+#include <cstdio>
+
+namespace MDR {
+    // Data retriever for a progressive stream written by ProgressiveStreamWriter
+    // the truncation-point table is read once; a retrieval extends the prefix read so far with one sequential read
+    // up to the last requested component, so with PlanBasedSizeInterpreter on the same plan it reads exactly the plan
+    class ProgressiveStreamRetriever : public concepts::RetrieverInterface {
+    public:
+        ProgressiveStreamRetriever(const std::string& metadata_file, const std::string& stream_file) : metadata_file(metadata_file), stream_file(stream_file) {
+            uint64_t table_size = 0;
+            read_file_range(stream_file, 0, sizeof(uint64_t), (uint8_t *) &table_size);
+            std::vector<uint8_t> table(table_size);
+            read_file_range(stream_file, sizeof(uint64_t), table_size, table.data());
+            uint8_t const * table_pos = table.data();
+            truncation_table.deserialize(table_pos);
+            data_offset = sizeof(uint64_t) + table_size;
+            for(size_t k=0; k<truncation_table.size(); k++){
+                int i = truncation_table.get_level(k);
+                int j = truncation_table.get_bitplane(k);
+                if(i >= entry_index.size()) entry_index.resize(i + 1);
+                if(j >= entry_index[i].size()) entry_index[i].resize(j + 1);
+                entry_index[i][j] = k;
+            }
+        }
+
+        std::vector<std::vector<const uint8_t*>> retrieve_level_components(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint64_t>& retrieve_sizes, const std::vector<uint8_t>& prev_level_num_bitplanes, const std::vector<uint8_t>& level_num_bitplanes){
+            assert(entry_index.size() == retrieve_sizes.size());
+            // extend the prefix up to the last requested component
+            size_t num_entries = 0;
+            for(int i=0; i<level_num_bitplanes.size(); i++){
+                if(level_num_bitplanes[i] > prev_level_num_bitplanes[i]){
+                    num_entries = std::max(num_entries, entry_index[i][level_num_bitplanes[i] - 1] + 1);
+                }
+            }
+            if(num_entries){
+                uint64_t prefix_size = truncation_table.get_cumulative_size(num_entries - 1);
+                if(prefix_size > prefix.size()){
+                    uint64_t read_size = prefix.size();
+                    prefix.resize(prefix_size);
+                    read_file_range(stream_file, data_offset + read_size, prefix_size - read_size, prefix.data() + read_size);
+                }
+            }
+            std::vector<std::vector<const uint8_t*>> level_components;
+            for(int i=0; i<level_num_bitplanes.size(); i++){
+                std::vector<const uint8_t*> interleaved_level;
+                for(int j=prev_level_num_bitplanes[i]; j<level_num_bitplanes[i]; j++){
+                    size_t k = entry_index[i][j];
+                    interleaved_level.push_back(prefix.data() + (k ? truncation_table.get_cumulative_size(k - 1) : 0));
+                }
+                level_components.push_back(interleaved_level);
+            }
+            return level_components;
+        }
+
+        uint8_t * load_metadata() const {
+            FILE * file = fopen(metadata_file.c_str(), "r");
+            fseek(file, 0, SEEK_END);
+            size_t num_bytes = ftell(file);
+            rewind(file);
+            uint8_t * metadata = (uint8_t *) malloc(num_bytes);
+            fread(metadata, 1, num_bytes, file);
+            fclose(file);
+            return metadata;
+        }
+
+        const RetrievalPlan& get_truncation_table() const {
+            return truncation_table;
+        }
+
+        // bytes of the stream read so far
+        uint64_t get_prefix_size() const {
+            return prefix.size();
+        }
+
+        // the prefix read so far is kept, since the next retrieval extends it
+        void release(){}
+
+        ~ProgressiveStreamRetriever(){}
+
+        void print() const {
+            std::cout << "Progressive stream retriever." << std::endl;
+        }
+    private:
+        std::string metadata_file;
+        std::string stream_file;
+        RetrievalPlan truncation_table;
+        uint64_t data_offset = 0;
+        // entry_index[i][j]: position of component j of level i in the stream
+        std::vector<std::vector<size_t>> entry_index;
+        std::vector<uint8_t> prefix;
+    };
+}
+#endif
@@ -2,5 +2,12 @@
 #define _MDR_RETRIEVER_HPP
 
 #include "FileRetriever.hpp"
+#include "MMapFileRetriever.hpp"
+#include "ParallelFileRetriever.hpp"
+#include "PrefetchFileRetriever.hpp"
+#include "ContainerFileRetriever.hpp"
+#include "PackedObjectRetriever.hpp"
+#include "ProgressiveStreamRetriever.hpp"
+#include "CachedFileRetriever.hpp"
 
 #endif
@@ -13,9 +13,10 @@ namespace MDR {
         InorderSizeInterpreter(const ErrorEstimator& e){
             error_estimator = e;
         }
-        std::vector<uint32_t> interpret_retrieve_size(const std::vector<std::vector<uint32_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+            tolerance = error_estimator.translate_tolerance(tolerance);
             const int num_levels = level_sizes.size();
-            std::vector<uint32_t> retrieve_sizes(num_levels, 0);
+            std::vector<uint64_t> retrieve_sizes(num_levels, 0);
             double accumulated_error = 0;
             for(int i=0; i<num_levels; i++){
                 accumulated_error += error_estimator.estimate_error(level_errors[i][index[i]], i);
@@ -34,7 +35,7 @@ namespace MDR {
                 }
                 if(tolerance_met) break;
             }
-            std::cout << "Requested tolerance = " << tolerance << ", estimated error = " << accumulated_error << std::endl;
+            estimated_error = accumulated_error;
             return retrieve_sizes;
         }
         void print() const {
@@ -50,9 +51,10 @@ namespace MDR {
         RoundRobinSizeInterpreter(const ErrorEstimator& e){
             error_estimator = e;
         }
-        std::vector<uint32_t> interpret_retrieve_size(const std::vector<std::vector<uint32_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+            tolerance = error_estimator.translate_tolerance(tolerance);
             const int num_levels = level_sizes.size();
-            std::vector<uint32_t> retrieve_sizes(num_levels, 0);
+            std::vector<uint64_t> retrieve_sizes(num_levels, 0);
             double accumulated_error = 0;
             for(int i=0; i<num_levels; i++){
                 accumulated_error += error_estimator.estimate_error(level_errors[i][index[i]], i);
@@ -101,7 +103,7 @@ namespace MDR {
                     if(tolerance_met) break;
                 }                
             }
-            std::cout << "Requested tolerance = " << tolerance << ", estimated error = " << accumulated_error << std::endl;
+            estimated_error = accumulated_error;
             return retrieve_sizes;
         }
         void print() const {
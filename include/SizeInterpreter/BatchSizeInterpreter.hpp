@@ -0,0 +1,26 @@
+#ifndef _MDR_BATCH_SIZE_INTERPRETER_HPP
+#define _MDR_BATCH_SIZE_INTERPRETER_HPP
+
+#include "SizeInterpreterInterface.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace MDR {
+    // nested retrieval plans for several tolerances in one pass
+    // tolerances are planned loosest first, each continuing from the previous plan, so every plan contains the looser ones
+    // (with IncrementalGreedyBasedSizeInterpreter without sign_exclude each step only pops the extra bitplanes)
+    // returns the bitplane counts of each plan in the order of tolerances; index ends at the tightest plan
+    template<class SizeInterpreter>
+    std::vector<std::vector<uint8_t>> interpret_retrieve_sizes(const SizeInterpreter& interpreter, const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, const std::vector<double>& tolerances, std::vector<uint8_t>& index){
+        std::vector<size_t> order(tolerances.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b){ return tolerances[a] > tolerances[b]; });
+        std::vector<std::vector<uint8_t>> plans(tolerances.size());
+        for(const auto& k:order){
+            interpreter.interpret_retrieve_size(level_sizes, level_errors, tolerances[k], index);
+            plans[k] = index;
+        }
+        return plans;
+    }
+}
+#endif
@@ -0,0 +1,196 @@
+#ifndef _MDR_COST_AWARE_SIZE_INTERPRETER_HPP
+#define _MDR_COST_AWARE_SIZE_INTERPRETER_HPP
+
+#include "SizeInterpreterInterface.hpp"
+#include "GreedyBasedSizeInterpreter.hpp"
+#include <cmath>
+#include <fstream>
+#include <queue>
+#include <sstream>
+#include <string>
+
+namespace MDR {
+    // time to read from a storage tier: latency per access plus bytes over bandwidth
+    struct TierCostModel{
+        double latency = 0;
+        double bandwidth = 1;
+        TierCostModel(){}
+        TierCostModel(double l, double b) : latency(l), bandwidth(b) {}
+        inline double time(uint64_t bytes) const {
+            return latency + bytes / bandwidth;
+        }
+    };
+    // one tier per line: latency (seconds) and bandwidth (bytes per second); blank lines are skipped
+    // num_tiers: number of tiers in use, checked against the file when positive
+    inline std::vector<TierCostModel> load_tier_cost_models(const std::string& filename, int num_tiers = 0){
+        std::vector<TierCostModel> tier_models;
+        std::ifstream file(filename);
+        if(!file.is_open()){
+            std::cerr << "Cannot open tier cost model file " << filename << std::endl;
+            exit(-1);
+        }
+        std::string line;
+        int line_number = 0;
+        while(std::getline(file, line)){
+            line_number ++;
+            if(line.find_first_not_of(" \t\r") == std::string::npos) continue;
+            std::istringstream fields(line);
+            double latency = 0, bandwidth = 0;
+            std::string rest;
+            if(!(fields >> latency >> bandwidth) || (fields >> rest) || !std::isfinite(latency) || !std::isfinite(bandwidth) || (latency < 0) || (bandwidth <= 0)){
+                std::cerr << "Tier cost model file " << filename << ", line " << line_number << ": expected latency >= 0 and bandwidth > 0, got \"" << line << "\"" << std::endl;
+                exit(-1);
+            }
+            tier_models.push_back(TierCostModel(latency, bandwidth));
+        }
+        if(tier_models.empty()){
+            std::cerr << "Tier cost model file " << filename << " has no tiers" << std::endl;
+            exit(-1);
+        }
+        if((num_tiers > 0) && (tier_models.size() != num_tiers)){
+            std::cerr << "Tier cost model file " << filename << " has " << tier_models.size() << " tiers, " << num_tiers << " in use" << std::endl;
+            exit(-1);
+        }
+        return tier_models;
+    }
+    inline void save_tier_cost_models(const std::string& filename, const std::vector<TierCostModel>& tier_models){
+        std::ofstream file(filename);
+        if(!file.is_open()){
+            std::cerr << "Cannot open tier cost model file " << filename << std::endl;
+            exit(-1);
+        }
+        for(const auto& model:tier_models){
+            file << model.latency << " " << model.bandwidth << std::endl;
+        }
+    }
+
+    // greedy bit-plane retrieval minimizing predicted read time instead of bytes
+    // level_tiers[i][j]: storage tier of bitplane j of level i
+    // tier_sizes: bytes read when a tier is first touched (e.g. erasure-coded tiers decoded as a whole), after which
+    // its bitplanes are free; tiers are recovered in order, so touching a tier also reads all lower tiers not read yet
+    // empty when bitplanes are read individually, paying the latency on the first access of a tier
+    // tiers of bitplanes below index are taken as already read
+    template<class ErrorEstimator>
+    class CostAwareSizeInterpreter : public concepts::SizeInterpreterInterface {
+    public:
+        CostAwareSizeInterpreter(const ErrorEstimator& e, const std::vector<TierCostModel>& tier_models, const std::vector<std::vector<uint8_t>>& level_tiers, const std::vector<uint64_t>& tier_sizes = std::vector<uint64_t>())
+            : tier_models(tier_models), level_tiers(level_tiers), tier_sizes(tier_sizes) {
+            error_estimator = e;
+            // every tier in use needs a model
+            size_t num_tiers = tier_sizes.size();
+            for(const auto& tiers:level_tiers){
+                for(const auto& tier:tiers){
+                    num_tiers = std::max<size_t>(num_tiers, tier + 1);
+                }
+            }
+            if(tier_models.size() < num_tiers){
+                std::cerr << "CostAwareSizeInterpreter: " << tier_models.size() << " tier cost models for " << num_tiers << " tiers." << std::endl;
+                exit(-1);
+            }
+        }
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+            tolerance = error_estimator.translate_tolerance(tolerance);
+            const int num_levels = level_sizes.size();
+            std::vector<uint64_t> retrieve_sizes(num_levels, 0);
+            std::vector<bool> touched(tier_models.size(), false);
+            double accumulated_error = 0;
+            for(int i=0; i<num_levels; i++){
+                accumulated_error += error_estimator.estimate_error(level_errors[i][index[i]], i);
+                for(int j=0; j<index[i]; j++){
+                    touch(touched, level_tiers[i][j]);
+                }
+            }
+            double predicted_time = 0;
+            std::priority_queue<UnitErrorGain, std::vector<UnitErrorGain>, CompareUnitErrorGain> heap;
+            auto push_next = [&](int i){
+                if(index[i] < level_sizes[i].size()){
+                    double error_gain = error_estimator.estimate_error_gain(accumulated_error, level_errors[i][index[i]], level_errors[i][index[i] + 1], i);
+                    heap.push(UnitErrorGain(error_gain / std::max(read_time(level_sizes, i, index[i], touched), min_time), i));
+                }
+            };
+            for(int i=0; i<num_levels; i++){
+                push_next(i);
+            }
+            while((accumulated_error >= tolerance) && (!heap.empty())){
+                int i = heap.top().level;
+                heap.pop();
+                int j = index[i];
+                uint8_t tier = level_tiers[i][j];
+                predicted_time += read_time(level_sizes, i, j, touched);
+                retrieve_sizes[i] += level_sizes[i][j];
+                accumulated_error -= error_estimator.estimate_error(level_errors[i][j], i);
+                accumulated_error += error_estimator.estimate_error(level_errors[i][j + 1], i);
+                index[i] ++;
+                if(!touched[tier]){
+                    // bitplanes of this tier got cheaper: reprice all levels
+                    touch(touched, tier);
+                    heap = std::priority_queue<UnitErrorGain, std::vector<UnitErrorGain>, CompareUnitErrorGain>();
+                    for(int l=0; l<num_levels; l++){
+                        push_next(l);
+                    }
+                }
+                else{
+                    push_next(i);
+                }
+            }
+            estimated_error = accumulated_error;
+            last_predicted_time = predicted_time;
+            return retrieve_sizes;
+        }
+        // predicted time of the last interpreted retrieval
+        double get_predicted_time() const {
+            return last_predicted_time;
+        }
+        // predicted time to read bitplanes [from_index, to_index) of every level, with tiers below from_index already read
+        double predict_time(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<uint8_t>& from_index, const std::vector<uint8_t>& to_index) const {
+            std::vector<bool> touched(tier_models.size(), false);
+            for(int i=0; i<from_index.size(); i++){
+                for(int j=0; j<from_index[i]; j++){
+                    touch(touched, level_tiers[i][j]);
+                }
+            }
+            double time = 0;
+            for(int i=0; i<from_index.size(); i++){
+                for(int j=from_index[i]; j<to_index[i]; j++){
+                    time += read_time(level_sizes, i, j, touched);
+                    touch(touched, level_tiers[i][j]);
+                }
+            }
+            return time;
+        }
+        void print() const {
+            std::cout << "I/O cost aware size interpreter." << std::endl;
+        }
+    private:
+        inline double read_time(const std::vector<std::vector<uint64_t>>& level_sizes, int i, int j, const std::vector<bool>& touched) const {
+            uint8_t tier = level_tiers[i][j];
+            const TierCostModel& model = tier_models[tier];
+            if(tier_sizes.size()){
+                // lower tiers not read yet are recovered along with this one
+                double time = 0;
+                for(int t=0; t<=tier; t++){
+                    if(!touched[t]) time += tier_models[t].time(tier_sizes[t]);
+                }
+                return time;
+            }
+            return (touched[tier] ? 0 : model.latency) + level_sizes[i][j] / model.bandwidth;
+        }
+        inline void touch(std::vector<bool>& touched, uint8_t tier) const {
+            if(tier_sizes.size()){
+                for(int t=0; t<=tier; t++){
+                    touched[t] = true;
+                }
+            }
+            else touched[tier] = true;
+        }
+
+        ErrorEstimator error_estimator;
+        std::vector<TierCostModel> tier_models;
+        std::vector<std::vector<uint8_t>> level_tiers;
+        std::vector<uint64_t> tier_sizes;
+        mutable double last_predicted_time = 0;
+        // keeps free bitplanes ordered by error gain
+        static constexpr double min_time = 1e-12;
+    };
+}
+#endif
@@ -25,9 +25,10 @@ namespace MDR {
         GreedyBasedSizeInterpreter(const ErrorEstimator& e){
             error_estimator = e;
         }
-        std::vector<uint32_t> interpret_retrieve_size(const std::vector<std::vector<uint32_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+            tolerance = error_estimator.translate_tolerance(tolerance);
             const int num_levels = level_sizes.size();
-            std::vector<uint32_t> retrieve_sizes(num_levels, 0);
+            std::vector<uint64_t> retrieve_sizes(num_levels, 0);
 
             double accumulated_error = 0;
             for(int i=0; i<num_levels; i++){
@@ -56,10 +57,8 @@ namespace MDR {
                     double error_gain = error_estimator.estimate_error_gain(accumulated_error, level_errors[i][index[i]], level_errors[i][index[i] + 1], i);
                     heap.push(UnitErrorGain(error_gain / level_sizes[i][index[i]], i));
                 }
-                std::cout << i;
             }
-            std::cout << std::endl;
-            std::cout << "Requested tolerance = " << tolerance << ", estimated error = " << accumulated_error << std::endl;
+            estimated_error = accumulated_error;
             return retrieve_sizes;
         }
         void print() const {
@@ -75,15 +74,10 @@ namespace MDR {
         SignExcludeGreedyBasedSizeInterpreter(const ErrorEstimator& e){
             error_estimator = e;
         }
-        std::vector<uint32_t> interpret_retrieve_size(const std::vector<std::vector<uint32_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
-            for(int i=0; i<level_errors.size(); i++){
-                for(int j=0; j<level_errors[i].size(); j++){
-                    std::cout << level_errors[i][j] << " ";
-                }
-                std::cout << std::endl;
-            }
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+            tolerance = error_estimator.translate_tolerance(tolerance);
             int num_levels = level_sizes.size();
-            std::vector<uint32_t> retrieve_sizes(num_levels, 0);
+            std::vector<uint64_t> retrieve_sizes(num_levels, 0);
             double accumulated_error = 0;
             for(int i=0; i<num_levels; i++){
                 accumulated_error += error_estimator.estimate_error(level_errors[i][index[i]], i);
@@ -100,7 +94,6 @@ namespace MDR {
                     accumulated_error -= error_estimator.estimate_error(level_errors[i][index[i]], i);
                     accumulated_error += error_estimator.estimate_error(level_errors[i][index[i] + 1], i);
                     index[i] ++;
-                    std::cout << i;
                 }
                 // push the next one
                 if(index[i] != level_sizes[i].size()){
@@ -131,10 +124,8 @@ namespace MDR {
                     double error_gain = error_estimator.estimate_error_gain(accumulated_error, level_errors[i][index[i]], level_errors[i][index[i] + 1], i);
                     heap.push(UnitErrorGain(error_gain / level_sizes[i][index[i]], i));
                 }
-                std::cout << i;
             }
-            std::cout << std::endl;
-            std::cout << "Requested tolerance = " << tolerance << ", estimated error = " << accumulated_error << std::endl;
+            estimated_error = accumulated_error;
             return retrieve_sizes;
         }
         void print() const {
@@ -162,9 +153,10 @@ namespace MDR {
         NegaBinaryGreedyBasedSizeInterpreter(const ErrorEstimator& e){
             error_estimator = e;
         }
-        std::vector<uint32_t> interpret_retrieve_size(const std::vector<std::vector<uint32_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+            tolerance = error_estimator.translate_tolerance(tolerance);
             int num_levels = level_sizes.size();
-            std::vector<uint32_t> retrieve_sizes(num_levels, 0);
+            std::vector<uint64_t> retrieve_sizes(num_levels, 0);
             double accumulated_error = 0;
             for(int i=0; i<num_levels; i++){
                 accumulated_error += error_estimator.estimate_error(level_errors[i][index[i]], i);
@@ -213,24 +205,22 @@ namespace MDR {
                 if(index[i] != level_sizes[i].size()){
                     heap.push(estimated_efficiency(accumulated_error, index[i], i, level_errors[i], level_sizes[i]));
                 }
-                for(int k=0; k<num; k++) std::cout << i;
             }
-            std::cout << std::endl;
-            std::cout << "Requested tolerance = " << tolerance << ", estimated error = " << accumulated_error << std::endl;
+            estimated_error = accumulated_error;
             return retrieve_sizes;
         }
         void print() const {
             std::cout << "Greedy based size interpreter for negabinary encoding." << std::endl;
         }
     private:
-        inline ConsecutiveUnitErrorGain estimated_efficiency(double accumulated_error, int index, int level, const std::vector<double>& bitplane_errors, const std::vector<uint32_t>& bitplane_sizes) const {
+        inline ConsecutiveUnitErrorGain estimated_efficiency(double accumulated_error, int index, int level, const std::vector<double>& bitplane_errors, const std::vector<uint64_t>& bitplane_sizes) const {
             double current_error_gain = error_estimator.estimate_error_gain(accumulated_error, bitplane_errors[index], bitplane_errors[index + 1], level);
-            uint32_t current_size = bitplane_sizes[index];
+            uint64_t current_size = bitplane_sizes[index];
             double current_efficiency = current_error_gain / current_size;
             int consecutive_num = 1;
             for(int i=2; i<bitplane_sizes.size() - index; i++){
                 double next_error_gain = error_estimator.estimate_error_gain(accumulated_error, bitplane_errors[index], bitplane_errors[index + i], level);             
-                uint32_t next_size = current_size + bitplane_sizes[index + i - 1];
+                uint64_t next_size = current_size + bitplane_sizes[index + i - 1];
                 double next_efficiency = next_error_gain / next_size;
                 if((current_efficiency > 0) && (current_efficiency > next_efficiency)){
                     break;
@@ -0,0 +1,134 @@
+#ifndef _MDR_INCREMENTAL_SIZE_INTERPRETER_HPP
+#define _MDR_INCREMENTAL_SIZE_INTERPRETER_HPP
+
+#include "SizeInterpreterInterface.hpp"
+#include "GreedyBasedSizeInterpreter.hpp"
+#include <queue>
+
+namespace MDR {
+    // greedy bit-plane retrieval that keeps the heap and accumulated error between calls
+    // a call resumes the previous session when it gets level sizes and errors equal to those of the session and the index
+    // left by the previous call, so a tighter tolerance only pops the extra bitplanes; otherwise the session is rebuilt from index
+    // a sequence of tightening tolerances gives at each tolerance what GreedyBasedSizeInterpreter gives from index 0
+    // sign_exclude: fetch the first component of each level up front and skip levels not needed for the tolerance; the level
+    // cutoff depends on index, so every call rebuilds the heap from index and gives what SignExcludeGreedyBasedSizeInterpreter
+    // gives when called with the same index; the session then only serves predict_next
+    template<class ErrorEstimator>
+    class IncrementalGreedyBasedSizeInterpreter : public concepts::SizeInterpreterInterface {
+    public:
+        IncrementalGreedyBasedSizeInterpreter(const ErrorEstimator& e, bool sign_exclude = false) : sign_exclude(sign_exclude) {
+            error_estimator = e;
+        }
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+            tolerance = error_estimator.translate_tolerance(tolerance);
+            if(sign_exclude || !resumable(level_sizes, level_errors, index)) start(level_sizes, level_errors, index);
+            const int num_levels = level_sizes.size();
+            std::vector<uint64_t> retrieve_sizes(num_levels, 0);
+            // bring in the next level while the best error of the active levels misses the tolerance
+            while((active_levels < num_levels) && ((active_levels == 0) || (min_error >= tolerance))){
+                activate_level(level_sizes, level_errors, index, retrieve_sizes);
+            }
+            while((accumulated_error >= tolerance) && (!heap.empty())){
+                auto unit_error_gain = heap.top();
+                heap.pop();
+                int i = unit_error_gain.level;
+                int j = index[i];
+                retrieve_sizes[i] += level_sizes[i][j];
+                accumulated_error -= error_estimator.estimate_error(level_errors[i][j], i);
+                accumulated_error += error_estimator.estimate_error(level_errors[i][j + 1], i);
+                index[i] ++;
+                push_next(level_sizes, level_errors, index, i);
+            }
+            session_index = index;
+            estimated_error = accumulated_error;
+            return retrieve_sizes;
+        }
+        // bitplane counts after the next picks of the session, up to max_items bitplanes or max_bytes:
+        // what a tighter tolerance would retrieve next, for prefetching; index itself if there is no session for it
+        std::vector<uint8_t> predict_next(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, const std::vector<uint8_t>& index, int max_items, uint64_t max_bytes) const {
+            std::vector<uint8_t> next_index(index);
+            if(!resumable(level_sizes, level_errors, index)) return next_index;
+            auto predicted_heap(heap);
+            double predicted_error = accumulated_error;
+            uint64_t bytes = 0;
+            for(int n=0; (n < max_items) && (!predicted_heap.empty()); n++){
+                int i = predicted_heap.top().level;
+                int j = next_index[i];
+                if(bytes + level_sizes[i][j] > max_bytes) break;
+                predicted_heap.pop();
+                bytes += level_sizes[i][j];
+                predicted_error -= error_estimator.estimate_error(level_errors[i][j], i);
+                predicted_error += error_estimator.estimate_error(level_errors[i][j + 1], i);
+                next_index[i] ++;
+                if(next_index[i] < level_sizes[i].size()){
+                    double error_gain = error_estimator.estimate_error_gain(predicted_error, level_errors[i][j + 1], level_errors[i][j + 2], i);
+                    predicted_heap.push(UnitErrorGain(error_gain / level_sizes[i][j + 1], i));
+                }
+            }
+            return next_index;
+        }
+        // drop the session so that the next call starts from its index
+        void reset(){
+            session_sizes.clear();
+            session_errors.clear();
+            session_index.clear();
+        }
+        void print() const {
+            std::cout << "Incremental greedy based size interpreter." << std::endl;
+        }
+    private:
+        bool resumable(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, const std::vector<uint8_t>& index) const {
+            return (session_index.size() == level_sizes.size()) && (session_index == index) && (session_sizes == level_sizes) && (session_errors == level_errors);
+        }
+        void start(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, const std::vector<uint8_t>& index) const {
+            const int num_levels = level_sizes.size();
+            session_sizes = level_sizes;
+            session_errors = level_errors;
+            heap = std::priority_queue<UnitErrorGain, std::vector<UnitErrorGain>, CompareUnitErrorGain>();
+            accumulated_error = 0;
+            for(int i=0; i<num_levels; i++){
+                accumulated_error += error_estimator.estimate_error(level_errors[i][index[i]], i);
+            }
+            min_error = accumulated_error;
+            active_levels = 0;
+            if(!sign_exclude){
+                for(int i=0; i<num_levels; i++){
+                    push_next(level_sizes, level_errors, index, i);
+                }
+                active_levels = num_levels;
+            }
+        }
+        void activate_level(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, std::vector<uint8_t>& index, std::vector<uint64_t>& retrieve_sizes) const {
+            int i = active_levels ++;
+            min_error -= error_estimator.estimate_error(level_errors[i][index[i]], i);
+            min_error += error_estimator.estimate_error(level_errors[i].back(), i);
+            // fetch the first component if index is 0
+            if((index[i] == 0) && level_sizes[i].size()){
+                retrieve_sizes[i] += level_sizes[i][0];
+                accumulated_error -= error_estimator.estimate_error(level_errors[i][0], i);
+                accumulated_error += error_estimator.estimate_error(level_errors[i][1], i);
+                index[i] ++;
+            }
+            push_next(level_sizes, level_errors, index, i);
+        }
+        inline void push_next(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, const std::vector<uint8_t>& index, int i) const {
+            if(index[i] < level_sizes[i].size()){
+                double error_gain = error_estimator.estimate_error_gain(accumulated_error, level_errors[i][index[i]], level_errors[i][index[i] + 1], i);
+                heap.push(UnitErrorGain(error_gain / level_sizes[i][index[i]], i));
+            }
+        }
+
+        ErrorEstimator error_estimator;
+        bool sign_exclude;
+        // session state carried between calls
+        // copies of the inputs of the session, compared by value so that a different vector at a reused address starts over
+        mutable std::vector<std::vector<uint64_t>> session_sizes;
+        mutable std::vector<std::vector<double>> session_errors;
+        mutable std::vector<uint8_t> session_index;
+        mutable std::priority_queue<UnitErrorGain, std::vector<UnitErrorGain>, CompareUnitErrorGain> heap;
+        mutable double accumulated_error = 0;
+        mutable double min_error = 0;
+        mutable int active_levels = 0;
+    };
+}
+#endif
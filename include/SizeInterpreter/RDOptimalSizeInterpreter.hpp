@@ -0,0 +1,177 @@
+#ifndef _MDR_RD_OPTIMAL_SIZE_INTERPRETER_HPP
+#define _MDR_RD_OPTIMAL_SIZE_INTERPRETER_HPP
+
+#include "SizeInterpreterInterface.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace MDR {
+    // rate-distortion optimal bit-plane retrieval: picks one truncation point per level minimizing the retrieved size
+    // under the tolerance (multi-choice knapsack over levels)
+    // the greedy walk over the per-level lower convex hulls gives an upper bound on the size; levels are then combined
+    // exactly over pareto fronts of (size, error), pruning states that cannot meet the tolerance or beat the bound
+    // gap: 0 (default) solves exactly; a positive gap thins the fronts to sizes at least (1 + gap) apart, which bounds
+    // their length on many levels and keeps the size within (1 + gap)^levels of the optimum
+    template<class ErrorEstimator>
+    class RDOptimalSizeInterpreter : public concepts::SizeInterpreterInterface {
+    public:
+        RDOptimalSizeInterpreter(const ErrorEstimator& e, double gap = 0) : gap(gap) {
+            error_estimator = e;
+        }
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+            tolerance = error_estimator.translate_tolerance(tolerance);
+            const int num_levels = level_sizes.size();
+            // candidate truncation points per level, pareto optimal within the level
+            std::vector<std::vector<Choice>> level_choices(num_levels);
+            for(int i=0; i<num_levels; i++){
+                uint64_t size = 0;
+                for(int k=index[i]; k<=level_sizes[i].size(); k++){
+                    double error = error_estimator.estimate_error(level_errors[i][k], i);
+                    if(level_choices[i].empty() || (error < level_choices[i].back().error)){
+                        level_choices[i].push_back(Choice(size, error, k));
+                    }
+                    if(k < level_sizes[i].size()) size += level_sizes[i][k];
+                }
+            }
+            // smallest error reachable by levels i..L-1
+            std::vector<double> min_remaining_error(num_levels + 1, 0);
+            for(int i=num_levels - 1; i>=0; i--){
+                min_remaining_error[i] = min_remaining_error[i + 1] + level_choices[i].back().error;
+            }
+            std::vector<int> selected(num_levels);
+            if(min_remaining_error[0] >= tolerance){
+                // tolerance cannot be met: retrieve the smallest error of every level
+                for(int i=0; i<num_levels; i++) selected[i] = level_choices[i].size() - 1;
+            }
+            else{
+                uint64_t bound = hull_greedy(level_choices, tolerance, selected);
+                optimize(level_choices, min_remaining_error, tolerance, bound, selected);
+            }
+            std::vector<uint64_t> retrieve_sizes(num_levels, 0);
+            double accumulated_error = 0;
+            for(int i=0; i<num_levels; i++){
+                const Choice& choice = level_choices[i][selected[i]];
+                retrieve_sizes[i] = choice.size;
+                index[i] = choice.index;
+                accumulated_error += choice.error;
+            }
+            estimated_error = accumulated_error;
+            return retrieve_sizes;
+        }
+        void print() const {
+            std::cout << "Rate-distortion optimal size interpreter." << std::endl;
+        }
+    private:
+        struct Choice{
+            uint64_t size;
+            double error;
+            int index;
+            Choice(uint64_t s, double e, int k) : size(s), error(e), index(k) {}
+        };
+        struct State{
+            uint64_t size;
+            double error;
+            // state of the previous level and the choice taken at this level
+            int parent;
+            int choice;
+        };
+        struct Segment{
+            double slope;
+            int level;
+            int choice;
+        };
+
+        // walk the lower convex hull segments of all levels by decreasing error reduction per byte
+        uint64_t hull_greedy(const std::vector<std::vector<Choice>>& level_choices, double tolerance, std::vector<int>& selected) const {
+            const int num_levels = level_choices.size();
+            std::vector<Segment> segments;
+            double accumulated_error = 0;
+            for(int i=0; i<num_levels; i++){
+                const auto& choices = level_choices[i];
+                std::vector<int> hull(1, 0);
+                for(int k=1; k<choices.size(); k++){
+                    // drop the last hull point while it lies on or above the segment to k
+                    while(hull.size() >= 2){
+                        const Choice& a = choices[hull[hull.size() - 2]];
+                        const Choice& b = choices[hull.back()];
+                        double cross = (double) (b.size - a.size) * (choices[k].error - a.error) - (b.error - a.error) * (double) (choices[k].size - a.size);
+                        if(cross > 0) break;
+                        hull.pop_back();
+                    }
+                    hull.push_back(k);
+                }
+                for(int h=1; h<hull.size(); h++){
+                    const Choice& a = choices[hull[h - 1]];
+                    const Choice& b = choices[hull[h]];
+                    segments.push_back({(a.error - b.error) / std::max<double>(b.size - a.size, 1), i, hull[h]});
+                }
+                selected[i] = 0;
+                accumulated_error += choices[0].error;
+            }
+            // slopes decrease along each hull, so a stable sort keeps segments of a level in order
+            std::stable_sort(segments.begin(), segments.end(), [](const Segment& s1, const Segment& s2){ return s1.slope > s2.slope; });
+            for(const auto& segment:segments){
+                if(accumulated_error < tolerance) break;
+                const auto& choices = level_choices[segment.level];
+                accumulated_error += choices[segment.choice].error - choices[selected[segment.level]].error;
+                selected[segment.level] = segment.choice;
+            }
+            uint64_t size = 0;
+            for(int i=0; i<num_levels; i++){
+                size += level_choices[i][selected[i]].size;
+            }
+            return size;
+        }
+
+        // combine levels over pareto fronts; keeps selected when no smaller feasible choice is found
+        void optimize(const std::vector<std::vector<Choice>>& level_choices, const std::vector<double>& min_remaining_error, double tolerance, uint64_t bound, std::vector<int>& selected) const {
+            const int num_levels = level_choices.size();
+            std::vector<std::vector<State>> fronts(num_levels + 1);
+            fronts[0].push_back({0, 0, -1, -1});
+            std::vector<State> candidates;
+            for(int i=0; i<num_levels; i++){
+                candidates.clear();
+                for(int p=0; p<fronts[i].size(); p++){
+                    const State& prev = fronts[i][p];
+                    for(int c=0; c<level_choices[i].size(); c++){
+                        const Choice& choice = level_choices[i][c];
+                        State state = {prev.size + choice.size, prev.error + choice.error, p, c};
+                        if(state.size > bound) break;
+                        if(state.error + min_remaining_error[i + 1] >= tolerance) continue;
+                        candidates.push_back(state);
+                    }
+                }
+                std::sort(candidates.begin(), candidates.end(), [](const State& s1, const State& s2){
+                    return (s1.size < s2.size) || ((s1.size == s2.size) && (s1.error < s2.error));
+                });
+                double best_error = std::numeric_limits<double>::max();
+                double kept_size = -1;
+                for(const auto& state:candidates){
+                    if(state.error >= best_error) continue;
+                    // thin: a state close in size to the last kept one only replaces it
+                    if(!fronts[i + 1].empty() && (state.size <= kept_size * (1 + gap))){
+                        fronts[i + 1].back() = state;
+                    }
+                    else{
+                        fronts[i + 1].push_back(state);
+                        kept_size = state.size;
+                    }
+                    best_error = state.error;
+                }
+                if(fronts[i + 1].empty()) return;
+            }
+            // the front is sorted by size and every state meets the tolerance
+            int s = 0;
+            if(fronts[num_levels][s].size > bound) return;
+            for(int i=num_levels; i>0; i--){
+                const State& state = fronts[i][s];
+                selected[i - 1] = state.choice;
+                s = state.parent;
+            }
+        }
+
+        ErrorEstimator error_estimator;
+        double gap;
+    };
+}
+#endif
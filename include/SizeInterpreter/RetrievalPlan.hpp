@@ -0,0 +1,257 @@
+#ifndef _MDR_RETRIEVAL_PLAN_HPP
+#define _MDR_RETRIEVAL_PLAN_HPP
+
+#include "SizeInterpreterInterface.hpp"
+#include "GreedyBasedSizeInterpreter.hpp"
+#include "RefactorUtils.hpp"
+#include <algorithm>
+#include <cstring>
+#include <queue>
+
+namespace MDR {
+    // greedy retrieval ordering precomputed at refactor time
+    // entry k is the k-th bitplane to fetch, with the bytes fetched and the estimated error after entries 0..k;
+    // errors are kept non-increasing (running minimum), so the first entry meeting a tolerance is found by binary search
+    // with sign_exclude, a tolerance is answered as SignExcludeGreedyBasedSizeInterpreter does: only the first levels
+    // whose full retrieval could meet it take part, and since the greedy order of a subset of levels is the full order
+    // restricted to them (the error gain of a bitplane depends on its own level), the plan keeps a table per number of levels
+    class RetrievalPlan {
+    public:
+        RetrievalPlan(){}
+        // sign_exclude: fetch the first component of every taking part level first, as SignExcludeGreedyBasedSizeInterpreter does
+        template<class ErrorEstimator>
+        RetrievalPlan(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, const ErrorEstimator& error_estimator, bool sign_exclude = true){
+            const int num_levels = level_sizes.size();
+            std::vector<uint8_t> index(num_levels, 0);
+            double accumulated_error = 0;
+            for(int i=0; i<num_levels; i++){
+                accumulated_error += error_estimator.estimate_error(level_errors[i][0], i);
+            }
+            initial_error = accumulated_error;
+            if(sign_exclude){
+                // error with levels 0..i fully retrieved
+                double min_error = accumulated_error;
+                for(int i=0; i<num_levels; i++){
+                    min_error -= error_estimator.estimate_error(level_errors[i][0], i);
+                    min_error += error_estimator.estimate_error(level_errors[i].back(), i);
+                    level_min_errors.push_back(min_error);
+                }
+            }
+            auto fetch = [&](int i){
+                int j = index[i] ++;
+                double prev_accumulated_error = accumulated_error;
+                accumulated_error -= error_estimator.estimate_error(level_errors[i][j], i);
+                accumulated_error += error_estimator.estimate_error(level_errors[i][j + 1], i);
+                uint64_t prev_size = cumulative_sizes.empty() ? 0 : cumulative_sizes.back();
+                double prev_error = errors.empty() ? initial_error : errors.back();
+                levels.push_back(i);
+                bitplanes.push_back(j);
+                cumulative_sizes.push_back(prev_size + level_sizes[i][j]);
+                errors.push_back(std::min(prev_error, accumulated_error));
+                gains.push_back(prev_accumulated_error - accumulated_error);
+            };
+            std::priority_queue<UnitErrorGain, std::vector<UnitErrorGain>, CompareUnitErrorGain> heap;
+            for(int i=0; i<num_levels; i++){
+                if(sign_exclude && level_sizes[i].size()) fetch(i);
+                if(index[i] < level_sizes[i].size()){
+                    double error_gain = error_estimator.estimate_error_gain(accumulated_error, level_errors[i][index[i]], level_errors[i][index[i] + 1], i);
+                    heap.push(UnitErrorGain(error_gain / level_sizes[i][index[i]], i));
+                }
+            }
+            while(!heap.empty()){
+                int i = heap.top().level;
+                heap.pop();
+                fetch(i);
+                if(index[i] < level_sizes[i].size()){
+                    double error_gain = error_estimator.estimate_error_gain(accumulated_error, level_errors[i][index[i]], level_errors[i][index[i] + 1], i);
+                    heap.push(UnitErrorGain(error_gain / level_sizes[i][index[i]], i));
+                }
+            }
+            build_cutoffs();
+        }
+
+        // number of leading entries of the table taking part for a tolerance in estimator units
+        size_t num_entries(double tolerance) const {
+            return num_entries(select(tolerance), tolerance);
+        }
+        // total bytes to fetch from scratch for a tolerance
+        uint64_t retrieve_bytes(double tolerance) const {
+            const Cutoff& cutoff = select(tolerance);
+            size_t n = num_entries(cutoff, tolerance);
+            return n ? cutoff.cumulative_sizes[n - 1] : 0;
+        }
+        double estimated_error(double tolerance) const {
+            const Cutoff& cutoff = select(tolerance);
+            size_t n = num_entries(cutoff, tolerance);
+            return n ? cutoff.errors[n - 1] : initial_error;
+        }
+        // number of leading entries that fit in a byte budget, the best answer for that many bytes
+        size_t num_entries_within(uint64_t bytes) const {
+            return std::upper_bound(cumulative_sizes.begin(), cumulative_sizes.end(), bytes) - cumulative_sizes.begin();
+        }
+        // advance index to the plan of a tolerance and return the sizes to fetch beyond index
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, double tolerance, std::vector<uint8_t>& index) const {
+            std::vector<uint64_t> retrieve_sizes(level_sizes.size(), 0);
+            const Cutoff& cutoff = select(tolerance);
+            size_t n = num_entries(cutoff, tolerance);
+            for(size_t m=0; m<n; m++){
+                size_t k = cutoff.entries[m];
+                int i = levels[k];
+                if(bitplanes[k] == index[i]){
+                    retrieve_sizes[i] += level_sizes[i][index[i]];
+                    index[i] ++;
+                }
+            }
+            return retrieve_sizes;
+        }
+
+        size_t size() const {
+            return levels.size();
+        }
+        // level and bitplane of entry k of the full order
+        uint8_t get_level(size_t k) const {
+            return levels[k];
+        }
+        uint8_t get_bitplane(size_t k) const {
+            return bitplanes[k];
+        }
+        // bytes of entries 0..k of the full order
+        uint64_t get_cumulative_size(size_t k) const {
+            return cumulative_sizes[k];
+        }
+        uint64_t get_size() const {
+            return sizeof(uint32_t) + sizeof(double) + levels.size() * (2 * sizeof(uint8_t) + sizeof(uint64_t) + 2 * sizeof(double))
+                    + sizeof(uint8_t) + level_min_errors.size() * sizeof(double);
+        }
+        void serialize(uint8_t *& buffer_pos) const {
+            uint32_t num = levels.size();
+            memcpy(buffer_pos, &num, sizeof(uint32_t));
+            buffer_pos += sizeof(uint32_t);
+            memcpy(buffer_pos, &initial_error, sizeof(double));
+            buffer_pos += sizeof(double);
+            MDR::serialize(levels, buffer_pos);
+            MDR::serialize(bitplanes, buffer_pos);
+            MDR::serialize(cumulative_sizes, buffer_pos);
+            MDR::serialize(errors, buffer_pos);
+            MDR::serialize(gains, buffer_pos);
+            *(buffer_pos ++) = (uint8_t) level_min_errors.size();
+            MDR::serialize(level_min_errors, buffer_pos);
+        }
+        void deserialize(uint8_t const *& buffer_pos){
+            uint32_t num = 0;
+            memcpy(&num, buffer_pos, sizeof(uint32_t));
+            buffer_pos += sizeof(uint32_t);
+            memcpy(&initial_error, buffer_pos, sizeof(double));
+            buffer_pos += sizeof(double);
+            MDR::deserialize(buffer_pos, num, levels);
+            MDR::deserialize(buffer_pos, num, bitplanes);
+            MDR::deserialize(buffer_pos, num, cumulative_sizes);
+            MDR::deserialize(buffer_pos, num, errors);
+            MDR::deserialize(buffer_pos, num, gains);
+            uint8_t num_levels = *(buffer_pos ++);
+            MDR::deserialize(buffer_pos, num_levels, level_min_errors);
+            build_cutoffs();
+        }
+    private:
+        // the entries of the first levels, with their bytes and errors
+        struct Cutoff{
+            std::vector<size_t> entries;
+            std::vector<uint64_t> cumulative_sizes;
+            std::vector<double> errors;
+            // leading first components, fetched whatever the tolerance
+            size_t num_first = 0;
+        };
+
+        // one table per number of levels taking part, or the full order without sign_exclude
+        void build_cutoffs(){
+            cutoffs.clear();
+            if(level_min_errors.empty()){
+                Cutoff cutoff;
+                for(size_t k=0; k<levels.size(); k++){
+                    cutoff.entries.push_back(k);
+                }
+                cutoff.cumulative_sizes = cumulative_sizes;
+                cutoff.errors = errors;
+                cutoffs.push_back(cutoff);
+                return;
+            }
+            for(int num_levels=1; num_levels<=level_min_errors.size(); num_levels++){
+                Cutoff cutoff;
+                uint64_t size = 0;
+                double accumulated_error = initial_error;
+                double error = initial_error;
+                bool leading = true;
+                for(size_t k=0; k<levels.size(); k++){
+                    if(levels[k] >= num_levels) continue;
+                    size += (k ? cumulative_sizes[k] - cumulative_sizes[k - 1] : cumulative_sizes[k]);
+                    accumulated_error -= gains[k];
+                    error = std::min(error, accumulated_error);
+                    cutoff.entries.push_back(k);
+                    cutoff.cumulative_sizes.push_back(size);
+                    cutoff.errors.push_back(error);
+                    if(leading && (bitplanes[k] == 0)) cutoff.num_first ++;
+                    else leading = false;
+                }
+                cutoffs.push_back(cutoff);
+            }
+        }
+
+        // table of the first levels whose full retrieval meets the tolerance, or of all levels
+        const Cutoff& select(double tolerance) const {
+            for(size_t i=0; i+1<cutoffs.size(); i++){
+                if(level_min_errors[i] < tolerance) return cutoffs[i];
+            }
+            return cutoffs.back();
+        }
+
+        size_t num_entries(const Cutoff& cutoff, double tolerance) const {
+            if(initial_error < tolerance) return cutoff.num_first;
+            // first entry with error < tolerance
+            auto it = std::partition_point(cutoff.errors.begin(), cutoff.errors.end(), [tolerance](double e){ return e >= tolerance; });
+            size_t n = (it == cutoff.errors.end()) ? cutoff.errors.size() : it - cutoff.errors.begin() + 1;
+            return std::max(n, cutoff.num_first);
+        }
+
+        double initial_error = 0;
+        std::vector<uint8_t> levels;
+        std::vector<uint8_t> bitplanes;
+        std::vector<uint64_t> cumulative_sizes;
+        std::vector<double> errors;
+        // raw error decrease of each entry
+        std::vector<double> gains;
+        // level_min_errors[i]: error with levels 0..i fully retrieved, empty without sign_exclude
+        std::vector<double> level_min_errors;
+        std::vector<Cutoff> cutoffs;
+    };
+
+    // size interpreter answering tolerances from a retrieval plan
+    // the plan is built with this estimator from the level errors on first use; the reconstructor installs the plan
+    // stored in metadata only for MaxErrorEstimatorOB and RelativeMaxErrorEstimatorOB, which share its units
+    template<class ErrorEstimator>
+    class PlanBasedSizeInterpreter : public concepts::SizeInterpreterInterface {
+    public:
+        PlanBasedSizeInterpreter(const ErrorEstimator& e, bool sign_exclude = true) : sign_exclude(sign_exclude) {
+            error_estimator = e;
+        }
+        std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const {
+            tolerance = error_estimator.translate_tolerance(tolerance);
+            if(plan.size() == 0) plan = RetrievalPlan(level_sizes, level_errors, error_estimator, sign_exclude);
+            estimated_error = plan.estimated_error(tolerance);
+            return plan.interpret_retrieve_size(level_sizes, tolerance, index);
+        }
+        void set_retrieval_plan(const RetrievalPlan& retrieval_plan){
+            plan = retrieval_plan;
+        }
+        const RetrievalPlan& get_retrieval_plan() const {
+            return plan;
+        }
+        void print() const {
+            std::cout << "Plan based size interpreter." << std::endl;
+        }
+    private:
+        ErrorEstimator error_estimator;
+        bool sign_exclude;
+        mutable RetrievalPlan plan;
+    };
+}
+#endif
@@ -3,5 +3,10 @@
 
 #include "BasicSizeInterpreter.hpp"
 #include "GreedyBasedSizeInterpreter.hpp"
+#include "IncrementalSizeInterpreter.hpp"
+#include "RDOptimalSizeInterpreter.hpp"
+#include "CostAwareSizeInterpreter.hpp"
+#include "RetrievalPlan.hpp"
+#include "BatchSizeInterpreter.hpp"
 
 #endif
@@ -10,9 +10,16 @@ namespace MDR {
 
             virtual ~SizeInterpreterInterface() = default;
 
-            virtual std::vector<uint32_t> interpret_retrieve_size(const std::vector<std::vector<uint32_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const = 0;
+            virtual std::vector<uint64_t> interpret_retrieve_size(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index) const = 0;
 
             virtual void print() const = 0;
+
+            // estimated error of the last interpreted retrieval
+            double get_estimated_error() const {
+                return estimated_error;
+            }
+        protected:
+            mutable double estimated_error = 0;
         };
     }
 }
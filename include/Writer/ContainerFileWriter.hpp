@@ -0,0 +1,110 @@
+#ifndef _MDR_CONTAINER_FILE_WRITER_HPP
+#define _MDR_CONTAINER_FILE_WRITER_HPP
+
+#include "WriterInterface.hpp"
+#include "ContainerFormat.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace MDR {
+    // A writer that writes all level components, metadata and an index into one self-indexed file
+    // write_level_components writes the components and write_metadata closes the container with the metadata, index and footer
+    class ContainerFileWriter : public concepts::WriterInterface {
+    public:
+        ContainerFileWriter(const std::string& filename, uint32_t alignment = CONTAINER_DEFAULT_ALIGNMENT) : filename(filename), alignment(alignment) {}
+
+        std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes) const {
+            int fd = open_file(O_TRUNC);
+            entries.clear();
+            data_end = 0;
+            num_levels = level_components.size();
+            std::vector<uint32_t> level_num;
+            for(int i=0; i<level_components.size(); i++){
+                data_end = ContainerFormat::align_up(data_end, alignment);
+                for(int j=0; j<level_components[i].size(); j++){
+                    ContainerFormat::Entry entry;
+                    entry.level = i;
+                    entry.bitplane = j;
+                    entry.checksum = StreamHeader::checksum(level_components[i][j], level_sizes[i][j]);
+                    entry.offset = data_end;
+                    entry.size = level_sizes[i][j];
+                    write_range(fd, level_components[i][j], entry.size, entry.offset);
+                    data_end += entry.size;
+                    entries.push_back(entry);
+                }
+                level_num.push_back(1);
+            }
+            close(fd);
+            written = true;
+            return level_num;
+        }
+
+        void write_metadata(uint8_t const * metadata, uint64_t size) const {
+            // an empty container if no components were written
+            int fd = open_file(written ? 0 : O_TRUNC);
+            if(!written){
+                entries.clear();
+                data_end = 0;
+                num_levels = 0;
+            }
+            ContainerFormat::Footer footer;
+            footer.alignment = alignment;
+            footer.metadata_offset = ContainerFormat::align_up(data_end, alignment);
+            footer.metadata_size = size;
+            footer.index_offset = footer.metadata_offset + size;
+            footer.num_entries = entries.size();
+            footer.num_levels = num_levels;
+            uint64_t index_size = entries.size() * CONTAINER_ENTRY_SIZE;
+            uint64_t tail_size = size + index_size + CONTAINER_FOOTER_SIZE;
+            uint8_t * tail = (uint8_t *) malloc(tail_size);
+            memcpy(tail, metadata, size);
+            ContainerFormat::write_index(entries, tail + size);
+            footer.index_checksum = StreamHeader::checksum(tail + size, index_size);
+            ContainerFormat::write_footer(footer, tail + size + index_size);
+            write_range(fd, tail, tail_size, footer.metadata_offset);
+            free(tail);
+            if(ftruncate(fd, footer.metadata_offset + tail_size)){
+                std::cerr << "Cannot truncate container " << filename << std::endl;
+                exit(-1);
+            }
+            close(fd);
+            written = false;
+        }
+
+        ~ContainerFileWriter(){}
+
+        void print() const {
+            std::cout << "Container file writer." << std::endl;
+        }
+    private:
+        int open_file(int flags) const {
+            int fd = open(filename.c_str(), O_WRONLY | O_CREAT | flags, 0644);
+            if(fd < 0){
+                std::cerr << "Cannot open container " << filename << " for writing" << std::endl;
+                exit(-1);
+            }
+            return fd;
+        }
+
+        void write_range(int fd, uint8_t const * data, uint64_t size, uint64_t offset) const {
+            uint64_t written_bytes = 0;
+            while(written_bytes < size){
+                ssize_t n = pwrite(fd, data + written_bytes, size - written_bytes, offset + written_bytes);
+                if(n <= 0){
+                    std::cerr << "Errors in pwrite while writing container " << filename << std::endl;
+                    exit(-1);
+                }
+                written_bytes += n;
+            }
+        }
+
+        std::string filename;
+        uint32_t alignment;
+        // index of the components written so far, completed by write_metadata
+        mutable std::vector<ContainerFormat::Entry> entries;
+        mutable uint64_t data_end = 0;
+        mutable uint32_t num_levels = 0;
+        mutable bool written = false;
+    };
+}
+#endif
@@ -0,0 +1,130 @@
+#ifndef _MDR_CONTAINER_FORMAT_HPP
+#define _MDR_CONTAINER_FORMAT_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "LosslessCompressor/StreamHeader.hpp"
+
+namespace MDR {
+    // single-file container of refactored data
+    /*
+        [level 0 components][pad][level 1 components][pad]...[metadata][index][footer]
+        components of a level are contiguous in bitplane order and each level starts on an alignment boundary,
+        so a progressive retrieval of a level is one read, which a direct I/O reader widens to alignment boundaries;
+        metadata, index and footer are contiguous at the tail, so a reader needs one open and one tail read
+        index entry (24 bytes): level u8 | bitplane u8 | codec u8 | reserved u8 | checksum u32 | offset u64 | size u64
+        footer (64 bytes): magic u64 | version u32 | alignment u32 | metadata offset u64 | metadata size u64
+                           | index offset u64 | number of entries u64 | index checksum u32 | number of levels u32 | reserved
+        the number of levels counts levels without components; containers that leave it 0 have as many levels as the index
+        all fields are little-endian
+    */
+    namespace ContainerFormat {
+        #define CONTAINER_MAGIC 0x31544e4f4352444dULL // "MDRCONT1"
+        #define CONTAINER_VERSION 1
+        #define CONTAINER_ENTRY_SIZE 24
+        #define CONTAINER_FOOTER_SIZE 64
+        #define CONTAINER_DEFAULT_ALIGNMENT 4096
+        // components are stored as handed over by the level compressor, which frames its own streams
+        #define CONTAINER_CODEC_PASSTHROUGH 0
+
+        struct Entry{
+            uint8_t level = 0;
+            uint8_t bitplane = 0;
+            uint8_t codec = CONTAINER_CODEC_PASSTHROUGH;
+            uint32_t checksum = 0;
+            uint64_t offset = 0;
+            uint64_t size = 0;
+        };
+
+        struct Footer{
+            uint32_t version = CONTAINER_VERSION;
+            uint32_t alignment = CONTAINER_DEFAULT_ALIGNMENT;
+            uint64_t metadata_offset = 0;
+            uint64_t metadata_size = 0;
+            uint64_t index_offset = 0;
+            uint64_t num_entries = 0;
+            uint32_t index_checksum = 0;
+            uint32_t num_levels = 0;
+        };
+
+        inline uint64_t align_up(uint64_t offset, uint32_t alignment){
+            return (offset + alignment - 1) / alignment * alignment;
+        }
+
+        template <class T>
+        inline void put(uint8_t *& buffer_pos, T value){
+            for(int i=0; i<sizeof(T); i++){
+                *(buffer_pos ++) = (value >> (8 * i)) & 0xff;
+            }
+        }
+
+        template <class T>
+        inline T get(uint8_t const *& buffer_pos){
+            T value = 0;
+            for(int i=0; i<sizeof(T); i++){
+                value |= (T) *(buffer_pos ++) << (8 * i);
+            }
+            return value;
+        }
+
+        // serialize entries into buffer of entries.size() * CONTAINER_ENTRY_SIZE bytes
+        inline void write_index(const std::vector<Entry>& entries, uint8_t * buffer){
+            uint8_t * buffer_pos = buffer;
+            for(const auto& entry:entries){
+                put<uint8_t>(buffer_pos, entry.level);
+                put<uint8_t>(buffer_pos, entry.bitplane);
+                put<uint8_t>(buffer_pos, entry.codec);
+                put<uint8_t>(buffer_pos, 0);
+                put<uint32_t>(buffer_pos, entry.checksum);
+                put<uint64_t>(buffer_pos, entry.offset);
+                put<uint64_t>(buffer_pos, entry.size);
+            }
+        }
+
+        inline std::vector<Entry> read_index(uint8_t const * buffer, uint64_t num_entries){
+            std::vector<Entry> entries(num_entries);
+            uint8_t const * buffer_pos = buffer;
+            for(auto& entry:entries){
+                entry.level = get<uint8_t>(buffer_pos);
+                entry.bitplane = get<uint8_t>(buffer_pos);
+                entry.codec = get<uint8_t>(buffer_pos);
+                buffer_pos ++;
+                entry.checksum = get<uint32_t>(buffer_pos);
+                entry.offset = get<uint64_t>(buffer_pos);
+                entry.size = get<uint64_t>(buffer_pos);
+            }
+            return entries;
+        }
+
+        inline void write_footer(const Footer& footer, uint8_t * buffer){
+            memset(buffer, 0, CONTAINER_FOOTER_SIZE);
+            uint8_t * buffer_pos = buffer;
+            put<uint64_t>(buffer_pos, CONTAINER_MAGIC);
+            put<uint32_t>(buffer_pos, footer.version);
+            put<uint32_t>(buffer_pos, footer.alignment);
+            put<uint64_t>(buffer_pos, footer.metadata_offset);
+            put<uint64_t>(buffer_pos, footer.metadata_size);
+            put<uint64_t>(buffer_pos, footer.index_offset);
+            put<uint64_t>(buffer_pos, footer.num_entries);
+            put<uint32_t>(buffer_pos, footer.index_checksum);
+            put<uint32_t>(buffer_pos, footer.num_levels);
+        }
+
+        // parse the footer; return false if it is not a container footer
+        inline bool read_footer(uint8_t const * buffer, Footer& footer){
+            uint8_t const * buffer_pos = buffer;
+            if(get<uint64_t>(buffer_pos) != CONTAINER_MAGIC) return false;
+            footer.version = get<uint32_t>(buffer_pos);
+            footer.alignment = get<uint32_t>(buffer_pos);
+            footer.metadata_offset = get<uint64_t>(buffer_pos);
+            footer.metadata_size = get<uint64_t>(buffer_pos);
+            footer.index_offset = get<uint64_t>(buffer_pos);
+            footer.num_entries = get<uint64_t>(buffer_pos);
+            footer.index_checksum = get<uint32_t>(buffer_pos);
+            footer.num_levels = get<uint32_t>(buffer_pos);
+            return footer.version == CONTAINER_VERSION;
+        }
+    }
+}
+#endif
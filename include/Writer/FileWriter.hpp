@@ -3,36 +3,144 @@
 
 #include "WriterInterface.hpp"
 #include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 namespace MDR {
+    #define DIRECT_IO_ALIGNMENT 4096
+    #define DIRECT_IO_STAGING_SIZE (4 << 20)
+
+    // write components [begin, end) back to back into a new file with pwritev, one iovec per component
+    inline void write_file_components(const std::string& filename, const std::vector<uint8_t*>& components, const std::vector<uint64_t>& sizes, int begin, int end){
+        int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(fd < 0){
+            std::cerr << "Cannot open file " << filename << " for writing" << std::endl;
+            exit(-1);
+        }
+        static const int max_iov = sysconf(_SC_IOV_MAX) > 0 ? sysconf(_SC_IOV_MAX) : 1024;
+        std::vector<struct iovec> iov;
+        for(int j=begin; j<end; j++){
+            if(sizes[j]) iov.push_back({components[j], sizes[j]});
+        }
+        uint64_t offset = 0;
+        size_t first = 0;
+        while(first < iov.size()){
+            int count = std::min<size_t>(iov.size() - first, max_iov);
+            ssize_t n = pwritev(fd, iov.data() + first, count, offset);
+            if(n <= 0){
+                std::cerr << "Errors in pwritev while writing file " << filename << std::endl;
+                exit(-1);
+            }
+            offset += n;
+            // skip the fully written iovecs and advance into a partially written one
+            while((first < iov.size()) && (n >= (ssize_t) iov[first].iov_len)){
+                n -= iov[first].iov_len;
+                first ++;
+            }
+            if(n){
+                iov[first].iov_base = (uint8_t *) iov[first].iov_base + n;
+                iov[first].iov_len -= n;
+            }
+        }
+        close(fd);
+    }
+
+    // write components [begin, end) with O_DIRECT through an aligned staging buffer, bypassing the page cache;
+    // the last block is padded and the file truncated to its size
+    // returns false without writing if the file system does not support O_DIRECT, on open or on the first write
+    inline bool write_file_components_direct(const std::string& filename, const std::vector<uint8_t*>& components, const std::vector<uint64_t>& sizes, int begin, int end){
+        int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+        if(fd < 0){
+            if(errno == EINVAL) return false;
+            std::cerr << "Cannot open file " << filename << " for writing" << std::endl;
+            exit(-1);
+        }
+        uint8_t * staging = NULL;
+        if(posix_memalign((void **) &staging, DIRECT_IO_ALIGNMENT, DIRECT_IO_STAGING_SIZE)){
+            std::cerr << "Cannot allocate staging buffer for " << filename << std::endl;
+            exit(-1);
+        }
+        uint64_t offset = 0;
+        uint64_t staged = 0;
+        // false if the first write is refused with EINVAL, as file systems accepting O_DIRECT on open may do
+        auto flush = [&](uint64_t length){
+            uint64_t written = 0;
+            while(written < length){
+                ssize_t n = pwrite(fd, staging + written, length - written, offset + written);
+                if(n <= 0){
+                    if((n < 0) && (errno == EINVAL) && (offset + written == 0)) return false;
+                    std::cerr << "Errors in pwrite while writing file " << filename << std::endl;
+                    exit(-1);
+                }
+                written += n;
+            }
+            offset += length;
+            return true;
+        };
+        auto give_up = [&](){
+            free(staging);
+            close(fd);
+            return false;
+        };
+        for(int j=begin; j<end; j++){
+            uint64_t copied = 0;
+            while(copied < sizes[j]){
+                uint64_t n = std::min(sizes[j] - copied, (uint64_t) DIRECT_IO_STAGING_SIZE - staged);
+                memcpy(staging + staged, components[j] + copied, n);
+                copied += n;
+                staged += n;
+                if(staged == DIRECT_IO_STAGING_SIZE){
+                    if(!flush(staged)) return give_up();
+                    staged = 0;
+                }
+            }
+        }
+        uint64_t size = offset + staged;
+        if(staged){
+            uint64_t padded = (staged + DIRECT_IO_ALIGNMENT - 1) / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT;
+            memset(staging + staged, 0, padded - staged);
+            if(!flush(padded)) return give_up();
+        }
+        free(staging);
+        if(ftruncate(fd, size)){
+            std::cerr << "Cannot truncate file " << filename << std::endl;
+            exit(-1);
+        }
+        close(fd);
+        return true;
+    }
+
     // A writer that writes the concatenated level components
+    // components are gathered straight from the compressor's buffers with pwritev instead of being concatenated first;
+    // with direct_io, levels of at least direct_io_threshold bytes are written with O_DIRECT
     class ConcatLevelFileWriter : public concepts::WriterInterface {
     public:
-        ConcatLevelFileWriter(const std::string& metadata_file, const std::vector<std::string>& level_files) : metadata_file(metadata_file), level_files(level_files) {}
+        ConcatLevelFileWriter(const std::string& metadata_file, const std::vector<std::string>& level_files, bool direct_io = false, uint64_t direct_io_threshold = 64 << 20)
+            : metadata_file(metadata_file), level_files(level_files), direct_io(direct_io), direct_io_threshold(direct_io_threshold) {}
 
-        std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint32_t>>& level_sizes) const {
+        std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes) const {
             std::vector<uint32_t> level_num;
             for(int i=0; i<level_components.size(); i++){
-                uint32_t concated_level_size = 0;
+                uint64_t concated_level_size = 0;
                 for(int j=0; j<level_components[i].size(); j++){
                     concated_level_size += level_sizes[i][j];
                 }
-                uint8_t * concated_level_data = (uint8_t *) malloc(concated_level_size);
-                uint8_t * concated_level_data_pos = concated_level_data;
-                for(int j=0; j<level_components[i].size(); j++){
-                    memcpy(concated_level_data_pos, level_components[i][j], level_sizes[i][j]);
-                    concated_level_data_pos += level_sizes[i][j];
+                bool written = false;
+                if(direct_io && (concated_level_size >= direct_io_threshold)){
+                    written = write_file_components_direct(level_files[i], level_components[i], level_sizes[i], 0, level_components[i].size());
+                }
+                if(!written){
+                    write_file_components(level_files[i], level_components[i], level_sizes[i], 0, level_components[i].size());
                 }
-                FILE * file = fopen((level_files[i]).c_str(), "w");
-                fwrite(concated_level_data, 1, concated_level_size, file);
-                fclose(file);
-                free(concated_level_data);
                 level_num.push_back(1);
             }
             return level_num;
         }
 
-        void write_metadata(uint8_t const * metadata, uint32_t size) const {
+        void write_metadata(uint8_t const * metadata, uint64_t size) const {
             FILE * file = fopen(metadata_file.c_str(), "w");
             fwrite(metadata, 1, size, file);
             fclose(file);
@@ -46,6 +154,8 @@ namespace MDR {
     private:
         std::vector<std::string> level_files;
         std::string metadata_file;
+        bool direct_io;
+        uint64_t direct_io_threshold;
     };
 }
 #endif
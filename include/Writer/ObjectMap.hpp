@@ -0,0 +1,95 @@
+#ifndef _MDR_OBJECT_MAP_HPP
+#define _MDR_OBJECT_MAP_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace MDR {
+    // where each (level, bitplane) component lives among packed objects
+    /*
+        appended to the metadata file after the refactor metadata, which readers parse from the front:
+        [metadata][object map][map size u64][OBJECT_MAP_MAGIC u64]
+        object map: number of objects u32 | object sizes u64...
+                    | number of levels u8 | per level: number of bitplanes u8 | per bitplane: object u32, offset u64, size u64
+    */
+    #define OBJECT_MAP_MAGIC 0x314d4a424f52444dULL // "MDROBJM1"
+
+    struct ObjectMap{
+        struct Location{
+            uint32_t object = 0;
+            uint64_t offset = 0;
+            uint64_t size = 0;
+        };
+        std::vector<uint64_t> object_sizes;
+        // locations[i][j]: component j of level i
+        std::vector<std::vector<Location>> locations;
+
+        // serialized size including the size and magic
+        uint64_t get_size() const {
+            uint64_t size = 2 * sizeof(uint64_t) + sizeof(uint32_t) + object_sizes.size() * sizeof(uint64_t) + sizeof(uint8_t);
+            for(const auto& level_locations:locations){
+                size += sizeof(uint8_t) + level_locations.size() * (sizeof(uint32_t) + 2 * sizeof(uint64_t));
+            }
+            return size;
+        }
+
+        // serialize the map followed by its size and the magic
+        void serialize(uint8_t *& buffer_pos) const {
+            uint8_t * buffer_start = buffer_pos;
+            write<uint32_t>(buffer_pos, object_sizes.size());
+            for(const auto& size:object_sizes){
+                write<uint64_t>(buffer_pos, size);
+            }
+            write<uint8_t>(buffer_pos, locations.size());
+            for(const auto& level_locations:locations){
+                write<uint8_t>(buffer_pos, level_locations.size());
+                for(const auto& location:level_locations){
+                    write<uint32_t>(buffer_pos, location.object);
+                    write<uint64_t>(buffer_pos, location.offset);
+                    write<uint64_t>(buffer_pos, location.size);
+                }
+            }
+            write<uint64_t>(buffer_pos, buffer_pos - buffer_start);
+            write<uint64_t>(buffer_pos, OBJECT_MAP_MAGIC);
+        }
+
+        // parse the map at the end of a metadata buffer; return false if there is none
+        bool deserialize_tail(uint8_t const * buffer, uint64_t buffer_size){
+            if(buffer_size < 2 * sizeof(uint64_t)) return false;
+            uint8_t const * tail_pos = buffer + buffer_size - 2 * sizeof(uint64_t);
+            uint64_t map_size = read<uint64_t>(tail_pos);
+            if((read<uint64_t>(tail_pos) != OBJECT_MAP_MAGIC) || (map_size > buffer_size - 2 * sizeof(uint64_t))) return false;
+            uint8_t const * buffer_pos = buffer + buffer_size - 2 * sizeof(uint64_t) - map_size;
+            object_sizes.resize(read<uint32_t>(buffer_pos));
+            for(auto& size:object_sizes){
+                size = read<uint64_t>(buffer_pos);
+            }
+            locations.resize(read<uint8_t>(buffer_pos));
+            for(auto& level_locations:locations){
+                level_locations.resize(read<uint8_t>(buffer_pos));
+                for(auto& location:level_locations){
+                    location.object = read<uint32_t>(buffer_pos);
+                    location.offset = read<uint64_t>(buffer_pos);
+                    location.size = read<uint64_t>(buffer_pos);
+                }
+            }
+            return true;
+        }
+
+    private:
+        template <class T>
+        static void write(uint8_t *& buffer_pos, T value){
+            memcpy(buffer_pos, &value, sizeof(T));
+            buffer_pos += sizeof(T);
+        }
+        template <class T>
+        static T read(uint8_t const *& buffer_pos){
+            T value;
+            memcpy(&value, buffer_pos, sizeof(T));
+            buffer_pos += sizeof(T);
+            return value;
+        }
+    };
+}
+#endif
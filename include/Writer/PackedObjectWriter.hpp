@@ -0,0 +1,132 @@
+#ifndef _MDR_PACKED_OBJECT_WRITER_HPP
+#define _MDR_PACKED_OBJECT_WRITER_HPP
+
+#include "WriterInterface.hpp"
+#include "FileWriter.hpp"
+#include "ObjectMap.hpp"
+#include "SizeInterpreter/RetrievalPlan.hpp"
+
+namespace MDR {
+    // A writer that packs components into objects of min_object_size to max_object_size bytes for tape and object stores
+    // components are packed in the order of the retrieval plan, so a retrieval reads a few whole objects,
+    // or level by level when there is no plan; an object is closed once it reaches min_object_size
+    // or the next component would take it past max_object_size, and a small last object joins the previous one if it fits
+    // objects are written to object_prefix + "_" + id and the object map is appended to the metadata
+    class PackedObjectWriter : public concepts::WriterInterface {
+    public:
+        PackedObjectWriter(const std::string& metadata_file, const std::string& object_prefix, uint64_t min_object_size, uint64_t max_object_size)
+            : metadata_file(metadata_file), object_prefix(object_prefix), min_object_size(min_object_size), max_object_size(std::max(min_object_size, max_object_size)) {}
+
+        void set_retrieval_plan(const RetrievalPlan& plan){
+            retrieval_plan = plan;
+        }
+
+        std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes) const {
+            const int num_levels = level_components.size();
+            // packing order
+            std::vector<std::pair<uint8_t, uint8_t>> order;
+            std::vector<uint8_t> index(num_levels, 0);
+            for(size_t k=0; k<retrieval_plan.size(); k++){
+                int i = retrieval_plan.get_level(k);
+                if((i < num_levels) && (retrieval_plan.get_bitplane(k) == index[i]) && (index[i] < level_components[i].size())){
+                    order.push_back(std::make_pair(i, index[i] ++));
+                }
+            }
+            // components the plan does not cover
+            for(int i=0; i<num_levels; i++){
+                for(int j=index[i]; j<level_components[i].size(); j++){
+                    order.push_back(std::make_pair(i, j));
+                }
+            }
+            // object k holds order entries [object_ends[k - 1], object_ends[k])
+            std::vector<size_t> object_ends;
+            std::vector<uint64_t> object_sizes;
+            uint64_t object_size = 0;
+            for(size_t k=0; k<order.size(); k++){
+                uint64_t size = level_sizes[order[k].first][order[k].second];
+                if(object_size && (object_size + size > max_object_size)){
+                    object_ends.push_back(k);
+                    object_sizes.push_back(object_size);
+                    object_size = 0;
+                }
+                object_size += size;
+                if(object_size >= min_object_size){
+                    object_ends.push_back(k + 1);
+                    object_sizes.push_back(object_size);
+                    object_size = 0;
+                }
+            }
+            if(object_size){
+                if(object_sizes.size() && (object_sizes.back() + object_size <= max_object_size)){
+                    object_ends.back() = order.size();
+                    object_sizes.back() += object_size;
+                }
+                else{
+                    object_ends.push_back(order.size());
+                    object_sizes.push_back(object_size);
+                }
+            }
+            // write objects and record where the components went
+            object_map = ObjectMap();
+            object_map.object_sizes = object_sizes;
+            object_map.locations.resize(num_levels);
+            for(int i=0; i<num_levels; i++){
+                object_map.locations[i].resize(level_components[i].size());
+            }
+            std::vector<std::vector<bool>> level_in_object(num_levels, std::vector<bool>(object_ends.size(), false));
+            size_t begin = 0;
+            for(uint32_t n=0; n<object_ends.size(); n++){
+                std::vector<uint8_t*> components;
+                std::vector<uint64_t> sizes;
+                uint64_t offset = 0;
+                for(size_t k=begin; k<object_ends[n]; k++){
+                    int i = order[k].first;
+                    int j = order[k].second;
+                    components.push_back(level_components[i][j]);
+                    sizes.push_back(level_sizes[i][j]);
+                    object_map.locations[i][j].object = n;
+                    object_map.locations[i][j].offset = offset;
+                    object_map.locations[i][j].size = level_sizes[i][j];
+                    offset += level_sizes[i][j];
+                    level_in_object[i][n] = true;
+                }
+                write_file_components(object_prefix + "_" + std::to_string(n), components, sizes, 0, components.size());
+                begin = object_ends[n];
+            }
+            // number of objects holding components of each level
+            std::vector<uint32_t> level_num;
+            for(int i=0; i<num_levels; i++){
+                level_num.push_back(std::count(level_in_object[i].begin(), level_in_object[i].end(), true));
+            }
+            return level_num;
+        }
+
+        // write the metadata followed by the object map
+        void write_metadata(uint8_t const * metadata, uint64_t size) const {
+            uint64_t packed_size = size + object_map.get_size();
+            uint8_t * packed_metadata = (uint8_t *) malloc(packed_size);
+            memcpy(packed_metadata, metadata, size);
+            uint8_t * packed_metadata_pos = packed_metadata + size;
+            object_map.serialize(packed_metadata_pos);
+            FILE * file = fopen(metadata_file.c_str(), "w");
+            fwrite(packed_metadata, 1, packed_size, file);
+            fclose(file);
+            free(packed_metadata);
+        }
+
+        ~PackedObjectWriter(){}
+
+        void print() const {
+            std::cout << "Packed object writer." << std::endl;
+        }
+    private:
+        std::string metadata_file;
+        std::string object_prefix;
+        uint64_t min_object_size;
+        uint64_t max_object_size;
+        RetrievalPlan retrieval_plan;
+        // map of the last written components, appended to the metadata
+        mutable ObjectMap object_map;
+    };
+}
+#endif
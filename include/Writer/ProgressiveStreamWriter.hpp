@@ -0,0 +1,48 @@
+#ifndef _MDR_PROGRESSIVE_STREAM_WRITER_HPP
+#define _MDR_PROGRESSIVE_STREAM_WRITER_HPP
+
+#include "WriterInterface.hpp"
+#include "Reorganizer/RDReorganizer.hpp"
+#include <cstdio>
+
+namespace MDR {
+    // A writer that writes all levels as one rate-distortion ordered progressive stream
+    // the refactor hands over its retrieval plan, which orders the stream and becomes its truncation-point table
+    class ProgressiveStreamWriter : public concepts::WriterInterface {
+    public:
+        ProgressiveStreamWriter(const std::string& metadata_file, const std::string& stream_file, const RDReorganizer& reorganizer = RDReorganizer())
+            : metadata_file(metadata_file), stream_file(stream_file), reorganizer(reorganizer) {}
+
+        void set_retrieval_plan(const RetrievalPlan& plan){
+            reorganizer.set_retrieval_plan(plan);
+        }
+
+        std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes) const {
+            std::vector<uint8_t> order;
+            uint64_t total_size = 0;
+            uint8_t * stream = reorganizer.reorganize(level_components, level_sizes, order, total_size);
+            FILE * file = fopen(stream_file.c_str(), "w");
+            fwrite(stream, 1, total_size, file);
+            fclose(file);
+            free(stream);
+            return std::vector<uint32_t>(level_components.size(), 1);
+        }
+
+        void write_metadata(uint8_t const * metadata, uint64_t size) const {
+            FILE * file = fopen(metadata_file.c_str(), "w");
+            fwrite(metadata, 1, size, file);
+            fclose(file);
+        }
+
+        ~ProgressiveStreamWriter(){}
+
+        void print() const {
+            std::cout << "Progressive stream writer." << std::endl;
+        }
+    private:
+        std::string metadata_file;
+        std::string stream_file;
+        RDReorganizer reorganizer;
+    };
+}
+#endif
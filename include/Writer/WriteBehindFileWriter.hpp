@@ -0,0 +1,165 @@
+#ifndef _MDR_WRITE_BEHIND_FILE_WRITER_HPP
+#define _MDR_WRITE_BEHIND_FILE_WRITER_HPP
+
+#include "WriterInterface.hpp"
+#include "FileWriter.hpp"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace MDR {
+    // A writer that persists the concatenated level components on background threads
+    // write_level queues a finished level and returns, so the refactor encodes the next level while it is written;
+    // it blocks while more than max_in_flight_bytes are queued or being written
+    // wait blocks until every queued level is written and flush also syncs the written files
+    // both return the number of files of each level queued since the last wait, which may be fewer than the level files
+    class WriteBehindLevelFileWriter : public concepts::WriterInterface {
+    public:
+        WriteBehindLevelFileWriter(const std::string& metadata_file, const std::vector<std::string>& level_files, int num_threads = 2, uint64_t max_in_flight_bytes = 256 << 20)
+            : metadata_file(metadata_file), level_files(level_files) {
+            state = std::make_shared<State>(num_threads, max_in_flight_bytes);
+        }
+
+        // queue level components for writing; the writer takes the components and frees them once written
+        void write_level(int level, const std::vector<uint8_t*>& components, const std::vector<uint64_t>& sizes){
+            Job job;
+            job.filename = level_files[level];
+            job.level = level;
+            job.components = components;
+            job.sizes = sizes;
+            for(const auto& size:sizes){
+                job.size += size;
+            }
+            state->push(std::move(job));
+        }
+
+        // block until all queued levels are written; returns the number of files of each queued level
+        std::vector<uint32_t> wait() const {
+            return state->wait();
+        }
+
+        // wait and sync the written level files to storage
+        std::vector<uint32_t> flush() const {
+            auto level_num = wait();
+            for(int i=0; i<level_num.size(); i++){
+                if(!level_num[i]) continue;
+                int fd = open(level_files[i].c_str(), O_WRONLY);
+                if((fd < 0) || fdatasync(fd)){
+                    std::cerr << "Cannot sync file " << level_files[i] << std::endl;
+                    exit(-1);
+                }
+                close(fd);
+            }
+            return level_num;
+        }
+
+        // synchronous write of components owned by the caller
+        std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes) const {
+            wait();
+            std::vector<uint32_t> level_num;
+            for(int i=0; i<level_components.size(); i++){
+                write_file_components(level_files[i], level_components[i], level_sizes[i], 0, level_components[i].size());
+                level_num.push_back(1);
+            }
+            return level_num;
+        }
+
+        void write_metadata(uint8_t const * metadata, uint64_t size) const {
+            FILE * file = fopen(metadata_file.c_str(), "w");
+            fwrite(metadata, 1, size, file);
+            fclose(file);
+        }
+
+        ~WriteBehindLevelFileWriter(){}
+
+        void print() const {
+            std::cout << "Write-behind file writer." << std::endl;
+        }
+    private:
+        struct Job{
+            std::string filename;
+            int level = 0;
+            std::vector<uint8_t*> components;
+            std::vector<uint64_t> sizes;
+            uint64_t size = 0;
+        };
+
+        // queue and workers, shared by copies of the writer and joined when the last one goes
+        struct State{
+            std::mutex mutex;
+            std::condition_variable changed;
+            std::deque<Job> jobs;
+            std::vector<std::thread> workers;
+            uint64_t max_in_flight_bytes;
+            uint64_t in_flight_bytes = 0;
+            int busy = 0;
+            bool stopping = false;
+            // sized by the highest level queued, so the metadata records only the levels written
+            std::vector<uint32_t> level_num;
+
+            State(int num_threads, uint64_t max_in_flight_bytes) : max_in_flight_bytes(max_in_flight_bytes) {
+                for(int i=0; i<std::max(num_threads, 1); i++){
+                    workers.push_back(std::thread(&State::work, this));
+                }
+            }
+
+            ~State(){
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    stopping = true;
+                }
+                changed.notify_all();
+                for(auto& worker:workers){
+                    worker.join();
+                }
+            }
+
+            void push(Job job){
+                std::unique_lock<std::mutex> lock(mutex);
+                // a level larger than the budget still goes when nothing else is in flight
+                changed.wait(lock, [&]{ return (in_flight_bytes == 0) || (in_flight_bytes + job.size <= max_in_flight_bytes); });
+                in_flight_bytes += job.size;
+                if(job.level >= level_num.size()) level_num.resize(job.level + 1, 0);
+                jobs.push_back(std::move(job));
+                changed.notify_all();
+            }
+
+            std::vector<uint32_t> wait(){
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]{ return jobs.empty() && (busy == 0); });
+                // the next refactor starts with no levels written
+                std::vector<uint32_t> written;
+                written.swap(level_num);
+                return written;
+            }
+
+            void work(){
+                std::unique_lock<std::mutex> lock(mutex);
+                while(true){
+                    changed.wait(lock, [&]{ return stopping || !jobs.empty(); });
+                    if(jobs.empty()) return;
+                    Job job = std::move(jobs.front());
+                    jobs.pop_front();
+                    busy ++;
+                    lock.unlock();
+                    write_file_components(job.filename, job.components, job.sizes, 0, job.components.size());
+                    for(auto& component:job.components){
+                        free(component);
+                    }
+                    lock.lock();
+                    busy --;
+                    in_flight_bytes -= job.size;
+                    level_num[job.level] = 1;
+                    changed.notify_all();
+                }
+            }
+        };
+
+        std::vector<std::string> level_files;
+        std::string metadata_file;
+        std::shared_ptr<State> state;
+    };
+}
+#endif
@@ -3,5 +3,9 @@
 
 #include "FileWriter.hpp"
 #include "HPSSFileWriter.hpp"
+#include "ContainerFileWriter.hpp"
+#include "WriteBehindFileWriter.hpp"
+#include "PackedObjectWriter.hpp"
+#include "ProgressiveStreamWriter.hpp"
 
 #endif
@@ -10,9 +10,9 @@ namespace MDR {
 
             virtual ~WriterInterface() = default;
 
-            virtual std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint32_t>>& level_sizes) const = 0;
+            virtual std::vector<uint32_t> write_level_components(const std::vector<std::vector<uint8_t*>>& level_components, const std::vector<std::vector<uint64_t>>& level_sizes) const = 0;
 
-            virtual void write_metadata(uint8_t const * metadata, uint32_t size) const = 0;
+            virtual void write_metadata(uint8_t const * metadata, uint64_t size) const = 0;
 
             virtual void print() const = 0;
         };
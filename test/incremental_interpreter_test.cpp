@@ -0,0 +1,140 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cmath>
+
+#include "../include/ErrorEstimator/ErrorEstimator.hpp"
+#include "../include/SizeInterpreter/SizeInterpreter.hpp"
+
+// equivalence test for IncrementalGreedyBasedSizeInterpreter over a sequence of tightening tolerances
+// 1. without sign_exclude it matches GreedyBasedSizeInterpreter planned from index 0 at every tolerance
+// 2. with sign_exclude it matches SignExcludeGreedyBasedSizeInterpreter called with the same sequence and index
+// 3. a session is not resumed when the level errors change in place, at the same address
+// usage: incremental_interpreter_test
+
+using T = float;
+
+int failures = 0;
+
+void check(bool condition, const std::string& what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+// bitplane sizes and non-increasing errors of num_levels levels, levels getting finer and larger
+void make_levels(int num_levels, int num_bitplanes, uint32_t seed, std::vector<std::vector<uint64_t>>& level_sizes, std::vector<std::vector<double>>& level_errors)
+{
+    uint32_t state = seed;
+    auto next = [&]() { state = state * 1103515245u + 12345u; return (state >> 8) / (double) (1 << 24); };
+    level_sizes.assign(num_levels, std::vector<uint64_t>(num_bitplanes));
+    level_errors.assign(num_levels, std::vector<double>(num_bitplanes + 1));
+    for (int i = 0; i < num_levels; i++)
+    {
+        uint64_t level_bytes = 64 << (3 * i);
+        double error = 10 * (1 + next()) / (1 << i);
+        level_errors[i][0] = error;
+        for (int j = 0; j < num_bitplanes; j++)
+        {
+            level_sizes[i][j] = 1 + (uint64_t) (level_bytes * (0.05 + next()) * std::min(1.0, (j + 1) / 8.0));
+            error *= 0.3 + 0.4 * next();
+            level_errors[i][j + 1] = error;
+        }
+    }
+}
+
+std::vector<double> tolerances()
+{
+    std::vector<double> result;
+    for (double tolerance = 20; tolerance > 1e-7; tolerance /= 3.7)
+    {
+        result.push_back(tolerance);
+    }
+    return result;
+}
+
+template <class Estimator>
+void test_plain(const Estimator& estimator, const std::string& name, uint32_t seed)
+{
+    std::vector<std::vector<uint64_t>> level_sizes;
+    std::vector<std::vector<double>> level_errors;
+    make_levels(4, 32, seed, level_sizes, level_errors);
+    auto incremental = MDR::IncrementalGreedyBasedSizeInterpreter<Estimator>(estimator);
+    auto greedy = MDR::GreedyBasedSizeInterpreter<Estimator>(estimator);
+    std::vector<uint8_t> index(level_sizes.size(), 0);
+    std::vector<uint64_t> total(level_sizes.size(), 0);
+    for (double tolerance : tolerances())
+    {
+        auto sizes = incremental.interpret_retrieve_size(level_sizes, level_errors, tolerance, index);
+        for (size_t i = 0; i < sizes.size(); i++) total[i] += sizes[i];
+        std::vector<uint8_t> one_shot_index(level_sizes.size(), 0);
+        auto one_shot_sizes = greedy.interpret_retrieve_size(level_sizes, level_errors, tolerance, one_shot_index);
+        check((index == one_shot_index) && (total == one_shot_sizes), name + ": incremental matches one-shot greedy at tolerance " + std::to_string(tolerance));
+        check(incremental.get_estimated_error() == greedy.get_estimated_error(), name + ": estimated error matches at tolerance " + std::to_string(tolerance));
+    }
+}
+
+template <class Estimator>
+void test_sign_exclude(const Estimator& estimator, const std::string& name, uint32_t seed)
+{
+    std::vector<std::vector<uint64_t>> level_sizes;
+    std::vector<std::vector<double>> level_errors;
+    make_levels(4, 32, seed, level_sizes, level_errors);
+    auto incremental = MDR::IncrementalGreedyBasedSizeInterpreter<Estimator>(estimator, true);
+    auto sign_exclude = MDR::SignExcludeGreedyBasedSizeInterpreter<Estimator>(estimator);
+    std::vector<uint8_t> index(level_sizes.size(), 0);
+    std::vector<uint8_t> progressive_index(level_sizes.size(), 0);
+    for (double tolerance : tolerances())
+    {
+        auto sizes = incremental.interpret_retrieve_size(level_sizes, level_errors, tolerance, index);
+        auto progressive_sizes = sign_exclude.interpret_retrieve_size(level_sizes, level_errors, tolerance, progressive_index);
+        check((index == progressive_index) && (sizes == progressive_sizes), name + ": incremental matches progressive sign-exclude at tolerance " + std::to_string(tolerance));
+        check(incremental.get_estimated_error() == sign_exclude.get_estimated_error(), name + ": estimated error matches at tolerance " + std::to_string(tolerance));
+    }
+}
+
+void test_changed_errors(uint32_t seed)
+{
+    using Estimator = MDR::MaxErrorEstimatorOB<T>;
+    std::vector<std::vector<uint64_t>> level_sizes;
+    std::vector<std::vector<double>> level_errors;
+    make_levels(4, 32, seed, level_sizes, level_errors);
+    auto incremental = MDR::IncrementalGreedyBasedSizeInterpreter<Estimator>(Estimator(3));
+    std::vector<uint8_t> index(level_sizes.size(), 0);
+    incremental.interpret_retrieve_size(level_sizes, level_errors, 1.0, index);
+
+    // same vector object, other errors: the session must be rebuilt from index
+    for (auto& errors : level_errors)
+    {
+        for (auto& error : errors) error *= 0.5;
+    }
+    check(incremental.predict_next(level_sizes, level_errors, index, 4, UINT64_MAX) == index, "predict_next has no session for changed errors");
+    std::vector<uint8_t> fresh_index(index);
+    auto sizes = incremental.interpret_retrieve_size(level_sizes, level_errors, 1e-3, index);
+    auto fresh = MDR::IncrementalGreedyBasedSizeInterpreter<Estimator>(Estimator(3));
+    auto fresh_sizes = fresh.interpret_retrieve_size(level_sizes, level_errors, 1e-3, fresh_index);
+    check((index == fresh_index) && (sizes == fresh_sizes), "changed errors at the same address start a new session");
+}
+
+int main(int argc, char *argv[])
+{
+    for (uint32_t seed = 1; seed <= 20; seed++)
+    {
+        test_plain(MDR::MaxErrorEstimatorOB<T>(3), "max OB, seed " + std::to_string(seed), seed);
+        test_plain(MDR::SNormErrorEstimator<T>(3, 3, 0), "s-norm, seed " + std::to_string(seed), seed);
+        test_sign_exclude(MDR::MaxErrorEstimatorOB<T>(3), "max OB sign-exclude, seed " + std::to_string(seed), seed);
+        test_sign_exclude(MDR::SNormErrorEstimator<T>(3, 3, 0), "s-norm sign-exclude, seed " + std::to_string(seed), seed);
+        test_changed_errors(seed);
+    }
+    if (failures)
+    {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "incremental interpreter test passed" << std::endl;
+    return 0;
+}
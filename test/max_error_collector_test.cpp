@@ -0,0 +1,61 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+
+#include "../include/ErrorCollector/ErrorCollector.hpp"
+
+// regression test for the bound based max errors of MaxErrorCollector
+// the errors must not increase with the number of bitplanes, including the step from the untruncated level to the
+// first bitplane, otherwise the greedy size interpreters see a negative error gain
+// usage: max_error_collector_test
+
+int failures = 0;
+
+template <class T>
+void check_level_error(T max_level_error, int num_bitplanes)
+{
+    auto collector = MDR::MaxErrorCollector<T>();
+    std::vector<double> max_e = collector.collect_level_error(NULL, 0, num_bitplanes, max_level_error);
+    if (max_e.size() != (size_t) num_bitplanes + 1)
+    {
+        std::cerr << "FAILED: " << max_e.size() << " errors for " << num_bitplanes << " bitplanes" << std::endl;
+        failures++;
+        return;
+    }
+    if (max_e[0] < max_level_error)
+    {
+        std::cerr << "FAILED: error " << max_e[0] << " without bitplanes is below the level max " << max_level_error << std::endl;
+        failures++;
+    }
+    for (size_t i = 1; i < max_e.size(); i++)
+    {
+        if (max_e[i] > max_e[i - 1])
+        {
+            std::cerr << "FAILED: max level error " << max_level_error << ", error " << max_e[i] << " after " << i
+                      << " bitplanes exceeds " << max_e[i - 1] << std::endl;
+            failures++;
+            return;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<double> maxLevelErrors = {17.16, 16, 15.99, 1, 0.75, 0.5, 1e-3, 3e-7, 1e5};
+    for (double maxLevelError : maxLevelErrors)
+    {
+        for (int numBitplanes : {1, 2, 32, 60})
+        {
+            check_level_error<float>(maxLevelError, numBitplanes);
+            check_level_error<double>(maxLevelError, numBitplanes);
+        }
+    }
+    if (failures)
+    {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "max error collector test passed" << std::endl;
+    return 0;
+}
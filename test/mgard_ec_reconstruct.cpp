@@ -36,9 +36,9 @@
 using namespace ROCKSDB_NAMESPACE;
 
 
-std::vector<std::vector<uint32_t>> get_level_sizes(uint32_t levels, const std::vector<std::vector<uint64_t>>& query_table)
+std::vector<std::vector<uint64_t>> get_level_sizes(uint32_t levels, const std::vector<std::vector<uint64_t>>& query_table)
 {
-    std::vector<std::vector<uint32_t>> level_sizes(levels);
+    std::vector<std::vector<uint64_t>> level_sizes(levels);
     for (size_t i = 0; i < query_table.size(); i++)
     {
         level_sizes[query_table[i][0]].push_back(query_table[i][4]);
@@ -46,6 +46,41 @@ std::vector<std::vector<uint32_t>> get_level_sizes(uint32_t levels, const std::v
     return level_sizes;   
 }
 
+// plan with the sign-excluding greedy interpreter or the rate-distortion optimal one, reporting the bytes of both;
+// with tier cost models, plan for the least predicted time and report the predicted time of all plans
+template <class ErrorEstimator>
+std::vector<uint8_t> plan_num_bitplanes(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, ErrorEstimator estimator, bool rd_optimal,
+                                        const std::vector<MDR::TierCostModel>& tier_models, const std::vector<std::vector<uint8_t>>& level_tiers, const std::vector<uint64_t>& tier_sizes)
+{
+    std::vector<uint8_t> greedy_num_bitplanes(level_sizes.size(), 0);
+    auto greedy_interpreter = MDR::SignExcludeGreedyBasedSizeInterpreter<ErrorEstimator>(estimator);
+    std::vector<uint64_t> greedy_sizes = greedy_interpreter.interpret_retrieve_size(level_sizes, level_errors, tolerance, greedy_num_bitplanes);
+    std::vector<uint8_t> rd_num_bitplanes(level_sizes.size(), 0);
+    auto rd_interpreter = MDR::RDOptimalSizeInterpreter<ErrorEstimator>(estimator);
+    std::vector<uint64_t> rd_sizes = rd_interpreter.interpret_retrieve_size(level_sizes, level_errors, tolerance, rd_num_bitplanes);
+    uint64_t greedy_bytes = std::accumulate(greedy_sizes.begin(), greedy_sizes.end(), (uint64_t) 0);
+    uint64_t rd_bytes = std::accumulate(rd_sizes.begin(), rd_sizes.end(), (uint64_t) 0);
+    std::cout << "planned bytes: greedy " << greedy_bytes << ", rate-distortion optimal " << rd_bytes;
+    if (greedy_bytes)
+    {
+        std::cout << " (" << 100.0 * ((double) greedy_bytes - (double) rd_bytes) / greedy_bytes << "% saved)";
+    }
+    std::cout << std::endl;
+    if (!tier_models.empty())
+    {
+        // erasure-coded tiers are recovered as a whole
+        std::vector<uint8_t> cost_num_bitplanes(level_sizes.size(), 0);
+        auto cost_interpreter = MDR::CostAwareSizeInterpreter<ErrorEstimator>(estimator, tier_models, level_tiers, tier_sizes);
+        cost_interpreter.interpret_retrieve_size(level_sizes, level_errors, tolerance, cost_num_bitplanes);
+        std::vector<uint8_t> no_bitplanes(level_sizes.size(), 0);
+        std::cout << "predicted time: greedy " << cost_interpreter.predict_time(level_sizes, no_bitplanes, greedy_num_bitplanes);
+        std::cout << " s, rate-distortion optimal " << cost_interpreter.predict_time(level_sizes, no_bitplanes, rd_num_bitplanes);
+        std::cout << " s, cost aware " << cost_interpreter.predict_time(level_sizes, no_bitplanes, cost_num_bitplanes) << " s" << std::endl;
+        return cost_num_bitplanes;
+    }
+    return rd_optimal ? rd_num_bitplanes : greedy_num_bitplanes;
+}
+
 
 void shuffle(std::vector<size_t> &arr, size_t n, unsigned int seed)
 {
@@ -127,10 +162,18 @@ int main(int argc, char *argv[])
 {
     std::string rocksDBPath;
     std::string variableName;
-    int error_mode = 0;
+    // 0: L-inf, 1: L2/s-norm; defaults to the mode the tiers were cut by
+    int error_mode = -1;
     int totalSites = 0;
     int unavaialbleSites = 0; 
-    double mgard_s_param;
+    double mgard_s_param = 0;
+    bool mgard_s_param_set = false;
+    // 0: reconstruct from all recoverable tiers
+    double tolerance = 0;
+    // plan with the rate-distortion optimal interpreter instead of the greedy one
+    bool rd_optimal = false;
+    // tier cost model file written by tier_calibrate: plan for the least predicted read time
+    std::string costModelFileName;
     std::string rawDataFileName;
     for (size_t i = 0; i < argc; i++)
     {
@@ -206,6 +249,7 @@ int main(int argc, char *argv[])
             if (i+1 < argc)
             {
                 mgard_s_param = atof(argv[i+1]);
+                mgard_s_param_set = true;
             }
             else
             {
@@ -213,6 +257,34 @@ int main(int argc, char *argv[])
                 return 1;
             }            
         }    
+        else if (arg == "-tol" || arg == "--tolerance")
+        {
+            if (i+1 < argc)
+            {
+                tolerance = atof(argv[i+1]);
+            }
+            else
+            {
+                std::cerr << "--tolerance option requires one argument." << std::endl;
+                return 1;
+            }            
+        }    
+        else if (arg == "-rd" || arg == "--rdoptimal")
+        {
+            rd_optimal = true;
+        }
+        else if (arg == "-cm" || arg == "--costmodel")
+        {
+            if (i+1 < argc)
+            {
+                costModelFileName = argv[i+1];
+            }
+            else
+            {
+                std::cerr << "--costmodel option requires one argument." << std::endl;
+                return 1;
+            }            
+        }
         else if (arg == "-r" || arg == "--rawdata")
         {
             if (i+1 < argc)
@@ -370,7 +442,21 @@ int main(int argc, char *argv[])
     {
         queryTable[i].insert(queryTable[i].end(), varQueryTable.begin()+i*varQueryTableShape[1], varQueryTable.begin()+i*varQueryTableShape[1]+varQueryTableShape[1]);
     }
-    std::vector<std::vector<uint32_t>> level_sizes = get_level_sizes(levels, queryTable);
+    std::vector<std::vector<uint64_t>> level_sizes = get_level_sizes(levels, queryTable);
+    // storage tier of every piece and the bytes recovered per tier, for the tier cost models
+    std::vector<std::vector<uint8_t>> level_tiers(levels);
+    std::vector<uint64_t> tier_sizes(tiers, 0);
+    for (size_t i = 0; i < queryTable.size(); i++)
+    {
+        level_tiers[queryTable[i][0]].push_back(queryTable[i][2]);
+        // components are padded to encoder words, so the tier extends to the end of its last component
+        tier_sizes[queryTable[i][2]] = std::max(tier_sizes[queryTable[i][2]], queryTable[i][3] + queryTable[i][4]);
+    }
+    std::vector<MDR::TierCostModel> tier_models;
+    if (!costModelFileName.empty())
+    {
+        tier_models = MDR::load_tier_cost_models(costModelFileName, tiers);
+    }
 
     std::string varSquaredErrorsShapeName = variableName+":SquaredErrors:Shape"; 
     std::string varSquaredErrorsShapeResult;
@@ -418,6 +504,44 @@ int main(int argc, char *argv[])
     //     std::cout << std::endl;
     // }
 
+    // max errors recorded at refactor time, absent in older key-value stores
+    std::vector<std::vector<double>> level_max_errors;
+    std::string varMaxErrorsName = variableName+":MaxErrors";
+    std::string varMaxErrorsResult;
+    s = db->Get(ReadOptions(), varMaxErrorsName, &varMaxErrorsResult);
+    if (s.ok())
+    {
+        std::vector<double> varMaxErrors = UnpackVector<double>(varMaxErrorsResult);
+        for (size_t i = 0; i < levels; i++)
+        {
+            level_max_errors.push_back(std::vector<double>(varMaxErrors.begin()+i*varSquaredErrorsShape[1], varMaxErrors.begin()+(i+1)*varSquaredErrorsShape[1]));
+        }
+    }
+
+    int32_t storedErrorMode = 0;
+    std::string varErrorModeName = variableName+":ErrorMode";
+    std::string varErrorModeResult;
+    s = db->Get(ReadOptions(), varErrorModeName, &varErrorModeResult);
+    if (s.ok())
+    {
+        storedErrorMode = *UnpackSingleElement<int32_t>(varErrorModeResult);
+    }
+    if (error_mode < 0)
+    {
+        error_mode = storedErrorMode;
+    }
+    std::string varSParamName = variableName+":SParam";
+    std::string varSParamResult;
+    s = db->Get(ReadOptions(), varSParamName, &varSParamResult);
+    if (s.ok() && !mgard_s_param_set)
+    {
+        mgard_s_param = *UnpackSingleElement<double>(varSParamResult);
+    }
+    if (error_mode != storedErrorMode)
+    {
+        std::cout << "warning: tiers were cut by error mode " << storedErrorMode << ", planning in error mode " << error_mode << std::endl;
+    }
+
     std::string varStopIndicesName = variableName+":StopIndices";
     std::string varStopIndicesResult;
     s = db->Get(ReadOptions(), varStopIndicesName, &varStopIndicesResult);
@@ -479,15 +603,51 @@ int main(int argc, char *argv[])
         std::vector<T> reconstructedData;
         switch(error_mode)
         {
+            case 0:
             case 1:
             {
-                std::cerr << "error mode = 1 is not supported!" << std::endl;
-                break;          
-            } 
-            default:
-            {
-                auto estimator = MDR::MaxErrorEstimatorOB<T>(dimensions.size());
-                auto interpreter = MDR::SignExcludeGreedyBasedSizeInterpreter<MDR::MaxErrorEstimatorOB<T>>(estimator); 
+                // plan the bitplanes needed for the requested tolerance in the error mode's norm,
+                // so that only the tiers holding them are recovered
+                std::vector<uint8_t> planned_num_bitplanes(levels, 0);
+                size_t neededTiers = tiers;
+                if (tolerance > 0)
+                {
+                    if (error_mode == 1)
+                    {
+                        auto estimator = MDR::SNormErrorEstimator<T>(dimensions.size(), levels-1, mgard_s_param);
+                        planned_num_bitplanes = plan_num_bitplanes(level_sizes, level_squared_errors, tolerance, estimator, rd_optimal, tier_models, level_tiers, tier_sizes);
+                    }
+                    else
+                    {
+                        if (level_max_errors.empty())
+                        {
+                            // refactored without recorded max errors: bound them from the level error bounds
+                            MDR::MaxErrorCollector<T> collector = MDR::MaxErrorCollector<T>();
+                            for (size_t i = 0; i < levels; i++)
+                            {
+                                level_max_errors.push_back(collector.collect_level_error(NULL, 0, level_squared_errors[i].size()-1, level_error_bounds[i]));
+                            }
+                        }
+                        auto estimator = MDR::MaxErrorEstimatorOB<T>(dimensions.size());
+                        planned_num_bitplanes = plan_num_bitplanes(level_sizes, level_max_errors, tolerance, estimator, rd_optimal, tier_models, level_tiers, tier_sizes);
+                    }
+                    neededTiers = 0;
+                    for (size_t j = 0; j < queryTable.size(); j++)
+                    {
+                        if (queryTable[j][1] < planned_num_bitplanes[queryTable[j][0]])
+                        {
+                            neededTiers = std::max(neededTiers, static_cast<size_t>(queryTable[j][2]+1));
+                        }
+                    }
+                    std::cout << neededTiers << " of " << tiers << " data tiers needed for tolerance " << tolerance << " in error mode " << error_mode << std::endl;
+                }
+                else
+                {
+                    for (size_t i = 0; i < levels; i++)
+                    {
+                        planned_num_bitplanes[i] = level_sizes[i].size();
+                    }
+                }
 
                 std::vector<std::vector<uint8_t>> dataTiersValues(tiers);
 
@@ -499,7 +659,7 @@ int main(int argc, char *argv[])
                 std::cout << std::endl;
 
                 size_t dataTiersRecovered = 0;
-                for (size_t i = 0; i < dataTiersValues.size(); i++)
+                for (size_t i = 0; i < neededTiers; i++)
                 {
                     if (dataTiersECParam_m[i] < unavaialbleSites)
                     {
@@ -655,8 +815,7 @@ int main(int argc, char *argv[])
                     assert(0 == rc);
 
                     uint8_t *tmp = static_cast<uint8_t*>(static_cast<void *>(decoded_data));  
-                    std::vector<uint8_t> oneTierDecodedData(tmp, tmp+decoded_data_len);
-                    dataTiersValues[i] = oneTierDecodedData;
+                    dataTiersValues[i].assign(tmp, tmp+decoded_data_len);
 
                     rc = liberasurecode_decode_cleanup(desc, decoded_data);
                     assert(rc == 0);
@@ -680,14 +839,14 @@ int main(int argc, char *argv[])
                 for (size_t j = 0; j < queryTable.size(); j++)
                 {
                     //std::cout << j << ": " << queryTable[j][0] << ", " << queryTable[j][1] << ", " << queryTable[j][2] << ", " << queryTable[j][3] << ", " << queryTable[j][5] << std::endl;
-                    if (queryTable[j][2] == dataTiersRecovered)
+                    if (queryTable[j][2] >= dataTiersRecovered || queryTable[j][1] >= planned_num_bitplanes[queryTable[j][0]])
                     {
-                        break;
+                        continue;
                     }
                     
-                    uint8_t * buffer = (uint8_t *) malloc(queryTable[j][4]);
-                    std::copy(dataTiersValues[queryTable[j][2]].begin()+queryTable[j][3], dataTiersValues[queryTable[j][2]].begin()+queryTable[j][3]+queryTable[j][4], buffer);
-                    level_components[queryTable[j][0]].push_back(buffer);
+                    // components are views into the recovered tier; the compressor only reads them, and raw bitplanes
+                    // decoded in place are aligned as the refactor pads every component to encoder words
+                    level_components[queryTable[j][0]].push_back(dataTiersValues[queryTable[j][2]].data()+queryTable[j][3]);
                     level_num_bitplanes[queryTable[j][0]]++;
                 }
                 int skipped_level = 0;
@@ -702,7 +861,7 @@ int main(int argc, char *argv[])
                 target_level -= skipped_level;
                 auto level_dims = MDR::compute_level_dims(dimensions, target_level);
                 auto reconstruct_dimensions = level_dims[target_level];
-                uint32_t num_elements = 1;
+                size_t num_elements = 1;
                 for(const auto& dim:reconstruct_dimensions)
                 {
                     num_elements *= dim;
@@ -725,12 +884,11 @@ int main(int argc, char *argv[])
                     //     std::cout << std::endl;
                     // }
                     
-                    compressor.decompress_level(level_components[j], level_sizes[j], 0, level_num_bitplanes[j], stopping_indices[j]);
+                    compressor.decompress_level_to_arena(level_components[j], level_sizes[j], 0, level_num_bitplanes[j], stopping_indices[j], j);
 
                     int level_exp = 0;
                     frexp(level_error_bounds[j], &level_exp);
                     auto level_decoded_data = encoder.progressive_decode(level_components[j], level_elements[j], level_exp, 0, level_num_bitplanes[j], j);
-                    compressor.decompress_release();
                     const std::vector<uint32_t>& prev_dims = (j == 0) ? dims_dummy : level_dims[j-1];
                     interleaver.reposition(level_decoded_data, reconstruct_dimensions, level_dims[j], prev_dims, reconstructedData.data());
                     free(level_decoded_data);
@@ -740,6 +898,12 @@ int main(int argc, char *argv[])
                 decomposer.recompose(reconstructedData.data(), reconstruct_dimensions, target_level);
                 MGARD::print_statistics(rawVariableData.data(), reconstructedData.data(), rawVariableData.size()); 
                 
+                break;
+            }
+            default:
+            {
+                std::cerr << "error mode = " << error_mode << " is not supported!" << std::endl;
+                break;
             }
         }
 
@@ -47,6 +47,13 @@ struct CompareUniteErrorGain{
     }
 };
 
+// component size rounded up to whole encoder words
+template <typename T_stream>
+uint64_t align_component_size(uint64_t size)
+{
+    return (size + sizeof(T_stream) - 1) / sizeof(T_stream) * sizeof(T_stream);
+}
+
 template <typename T>
 std::string PackSingleElement(const T* data)
 {
@@ -83,9 +90,10 @@ std::vector<T> UnpackVector(const std::string& data)
     return d;
 }
 
-template <class T>
-std::vector<std::tuple<uint32_t, uint32_t>> calculate_retrieve_order(const std::vector<std::vector<uint32_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index, MDR::MaxErrorEstimatorOB<T> error_estimator) 
+template <class ErrorEstimator>
+std::vector<std::tuple<uint32_t, uint32_t>> calculate_retrieve_order(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, double tolerance, std::vector<uint8_t>& index, ErrorEstimator error_estimator) 
 {
+    tolerance = error_estimator.translate_tolerance(tolerance);
     size_t num_levels = level_sizes.size();
     std::vector<std::tuple<uint32_t, uint32_t>> retrieve_order;
     double accumulated_error = 0;
@@ -169,6 +177,9 @@ int main(int argc, char *argv[])
     size_t total_mgard_levels = 0;
     size_t num_bitplanes = 0;
     std::string rocksDBPath;
+    // 0: tiers are cut by L-inf error, 1: tiers are cut by L2/s-norm error
+    int error_mode = 0;
+    double mgard_s_param = 0;
 
     ec_backend_id_t backendID;
 
@@ -286,6 +297,30 @@ int main(int argc, char *argv[])
                 return 1;
             }
         }             
+        else if (arg == "-em" || arg == "--errormode")
+        {
+            if (i+1 < argc)
+            {
+                error_mode = atoi(argv[i+1]);
+            }
+            else
+            {
+                std::cerr << "--errormode option requires one argument." << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "-s")
+        {
+            if (i+1 < argc)
+            {
+                mgard_s_param = atof(argv[i+1]);
+            }
+            else
+            {
+                std::cerr << "-s option requires one argument." << std::endl;
+                return 1;
+            }
+        }
     } 
 
     if (ECBackendName == "flat_xor_hd")
@@ -412,7 +447,7 @@ int main(int argc, char *argv[])
         std::string variableType;
         variableName = variablePair.first;
         variableType = variablePair.second.at("Type");    
-        std::vector<uint32_t> storageTiersSizes;
+        std::vector<uint64_t> storageTiersSizes;
         
         if (variableType == "float")
         {
@@ -449,8 +484,9 @@ int main(int argc, char *argv[])
             std::vector<uint32_t> dimensions(spaceDimensions);
             std::vector<T> level_error_bounds;
             std::vector<std::vector<uint8_t*>> level_components;
-            std::vector<std::vector<uint32_t>> level_sizes;
+            std::vector<std::vector<uint64_t>> level_sizes;
             std::vector<std::vector<double>> level_squared_errors;
+            std::vector<std::vector<double>> level_max_errors;
             std::vector<uint8_t> stopping_indices;
 
             for (size_t i = 0; i < variable.Shape().size(); i++)
@@ -489,11 +525,13 @@ int main(int argc, char *argv[])
                 // encode level data
                 int level_exp = 0;
                 frexp(level_max_error, &level_exp);
-                std::vector<uint32_t> stream_sizes;
+                std::vector<uint64_t> stream_sizes;
                 std::vector<double> level_sq_err;
-                auto streams = encoder.encode(buffer, level_elements[i], level_exp, num_bitplanes, stream_sizes, level_sq_err);
+                std::vector<double> level_max_err;
+                auto streams = encoder.encode(buffer, level_elements[i], level_exp, num_bitplanes, stream_sizes, level_sq_err, level_max_err);
                 free(buffer);
                 level_squared_errors.push_back(level_sq_err);
+                level_max_errors.push_back(level_max_err);
                 // lossless compression
                 uint8_t stopping_index = compressor.compress_level(streams, stream_sizes);
                 stopping_indices.push_back(stopping_index);
@@ -511,33 +549,50 @@ int main(int argc, char *argv[])
                 std::vector<uint8_t> oneDataTierValues;
                 uint64_t currentTierCopidedSize = 0;
                 
-                std::vector<std::vector<double>> level_abs_errors;
-                std::vector<std::vector<double>> level_errors;
-                target_level = level_error_bounds.size() - 1;
-                MDR::MaxErrorCollector<T> collector = MDR::MaxErrorCollector<T>();
-                for(size_t j = 0; j <= target_level; j++)
+                std::vector<std::tuple<uint32_t, uint32_t>> retrieve_order;
+                if (error_mode == 1)
+                {
+                    // squared errors collected by the encoder while encoding
+                    auto estimator = MDR::SNormErrorEstimator<T>(spaceDimensions, target_level, mgard_s_param);
+                    retrieve_order = calculate_retrieve_order(level_sizes, level_squared_errors, dataTiersTolerance[i], level_num_bitplanes, estimator);
+                }
+                else
                 {
-                    auto collected_error = collector.collect_level_error(NULL, 0, level_squared_errors[j].size(), level_error_bounds[j]);
-                    level_abs_errors.push_back(collected_error);
+                    // max errors recorded by the encoder while encoding
+                    auto estimator = MDR::MaxErrorEstimatorOB<T>(spaceDimensions); 
+                    retrieve_order = calculate_retrieve_order(level_sizes, level_max_errors, dataTiersTolerance[i], level_num_bitplanes, estimator);        
                 }
-                level_errors = level_abs_errors;       
-                auto estimator = MDR::MaxErrorEstimatorOB<T>(spaceDimensions); 
-                auto retrieve_order = calculate_retrieve_order(level_sizes, level_errors, dataTiersTolerance[i], level_num_bitplanes, estimator);        
+                size_t oneDataTierSize = 0;
+                for (size_t j = 0; j < retrieve_order.size(); j++)
+                {
+                    oneDataTierSize += align_component_size<T_stream>(level_sizes[std::get<0>(retrieve_order[j])][std::get<1>(retrieve_order[j])]);
+                }
+                oneDataTierValues.reserve(oneDataTierSize);
                 for (size_t j = 0; j < retrieve_order.size(); j++)
                 {
                     uint64_t lid = std::get<0>(retrieve_order[j]);
                     uint64_t pid = std::get<1>(retrieve_order[j]);
-                    std::vector<uint8_t> onePieceValues(level_components[lid][pid], level_components[lid][pid]+level_sizes[lid][pid]);
-                    oneDataTierValues.insert(oneDataTierValues.end(), onePieceValues.begin(), onePieceValues.end());
+                    // gather the encoded component straight into the tier handed to the erasure coder,
+                    // padded so that the next one starts on an encoder word for in-place decoding of raw bitplanes
+                    oneDataTierValues.insert(oneDataTierValues.end(), level_components[lid][pid], level_components[lid][pid]+level_sizes[lid][pid]);
+                    oneDataTierValues.resize(oneDataTierValues.size() + align_component_size<T_stream>(level_sizes[lid][pid]) - level_sizes[lid][pid], 0);
                     uint64_t tier_id = i;
                     uint64_t tier_size = level_sizes[lid][pid];
                     std::vector<uint64_t> row = {lid, pid, tier_id, currentTierCopidedSize, tier_size};
                     queryTable.push_back(row);
-                    currentTierCopidedSize += level_sizes[lid][pid];
+                    currentTierCopidedSize += align_component_size<T_stream>(level_sizes[lid][pid]);
                 }
-                dataTiersValues.push_back(oneDataTierValues);
-                std::cout << "tier " << i << " size: " << oneDataTierValues.size() << std::endl;
+                dataTiersValues.push_back(std::move(oneDataTierValues));
+                std::cout << "tier " << i << " size: " << dataTiersValues.back().size() << std::endl;
             }                  
+            // encoded components now live in the data tiers
+            for (size_t j = 0; j < level_components.size(); j++)
+            {
+                for (size_t k = 0; k < level_components[j].size(); k++)
+                {
+                    free(level_components[j][k]);
+                }
+            }
             std::cout << "query table content: " << std::endl;
             std::vector<uint64_t> queryTableContent;  
             for (size_t i = 0; i < queryTable.size(); i++)
@@ -727,6 +782,25 @@ int main(int argc, char *argv[])
                 
             }
 
+            std::vector<double> all_max_errors;
+            for (size_t i = 0; i < level_max_errors.size(); i++)
+            {
+                all_max_errors.insert(all_max_errors.end(), level_max_errors[i].begin(), level_max_errors[i].end());
+            }
+            // same shape as the squared errors
+            std::string varMaxErrorsName = variableName+":MaxErrors";
+            s = db->Put(WriteOptions(), varMaxErrorsName, PackVector(all_max_errors));
+            assert(s.ok()); 
+
+            // error norm the tiers were cut by, with the s parameter of the s-norm
+            std::string varErrorModeName = variableName+":ErrorMode";
+            int32_t storedErrorMode = error_mode;
+            s = db->Put(WriteOptions(), varErrorModeName, PackSingleElement(&storedErrorMode));
+            assert(s.ok()); 
+            std::string varSParamName = variableName+":SParam";
+            s = db->Put(WriteOptions(), varSParamName, PackSingleElement(&mgard_s_param));
+            assert(s.ok()); 
+
             std::string varTiersName = variableName+":Tiers";
             //adios2::Variable<uint32_t> varTiers = writer_io.DefineVariable<uint32_t>(varTiersName);
             uint32_t numTiers = dataTiers;
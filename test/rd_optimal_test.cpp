@@ -0,0 +1,153 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <numeric>
+
+#include "../include/ErrorEstimator/ErrorEstimator.hpp"
+#include "../include/SizeInterpreter/SizeInterpreter.hpp"
+
+// brute-force check of RDOptimalSizeInterpreter
+// random level profiles, with non-monotone errors as negabinary encoding records them, are planned at several tolerances
+// and starting indices; every plan must meet the tolerance when it can be met, and with the default gap its size must equal
+// the smallest size over all combinations of truncation points; with a positive gap it must be within (1 + gap)^levels
+// the bytes saved against the sign-excluding greedy interpreter are reported
+// usage: rd_optimal_test [# of profiles]
+
+using T = float;
+using Estimator = MDR::MaxErrorEstimatorOB<T>;
+
+int failures = 0;
+
+void check(bool condition, const std::string& what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+struct Random
+{
+    uint32_t state;
+    double next()
+    {
+        state = state * 1103515245u + 12345u;
+        return (state >> 8) / (double) (1 << 24);
+    }
+};
+
+void make_levels(int num_levels, int num_bitplanes, Random& random, std::vector<std::vector<uint64_t>>& level_sizes, std::vector<std::vector<double>>& level_errors)
+{
+    level_sizes.assign(num_levels, std::vector<uint64_t>(num_bitplanes));
+    level_errors.assign(num_levels, std::vector<double>(num_bitplanes + 1));
+    for (int i = 0; i < num_levels; i++)
+    {
+        double error = 8 * (1 + random.next()) / (1 << i);
+        level_errors[i][0] = error;
+        for (int j = 0; j < num_bitplanes; j++)
+        {
+            level_sizes[i][j] = 1 + (uint64_t) ((100 << (2 * i)) * random.next());
+            // mostly halving, occasionally rising as negabinary errors do
+            error *= (random.next() < 0.15) ? 1.2 : 0.3 + 0.4 * random.next();
+            level_errors[i][j + 1] = error;
+        }
+    }
+}
+
+// smallest size over all truncation points from index, UINT64_MAX if the tolerance cannot be met
+uint64_t brute_force(const std::vector<std::vector<uint64_t>>& level_sizes, const std::vector<std::vector<double>>& level_errors, const std::vector<uint8_t>& index, const Estimator& estimator, double tolerance)
+{
+    const int num_levels = level_sizes.size();
+    std::vector<int> choice(index.begin(), index.end());
+    uint64_t best = UINT64_MAX;
+    while (true)
+    {
+        uint64_t size = 0;
+        double error = 0;
+        for (int i = 0; i < num_levels; i++)
+        {
+            for (int k = index[i]; k < choice[i]; k++) size += level_sizes[i][k];
+            error += estimator.estimate_error(level_errors[i][choice[i]], i);
+        }
+        if ((error < tolerance) && (size < best)) best = size;
+        int i = 0;
+        while ((i < num_levels) && (choice[i] == (int) level_sizes[i].size()))
+        {
+            choice[i] = index[i];
+            i++;
+        }
+        if (i == num_levels) break;
+        choice[i]++;
+    }
+    return best;
+}
+
+int main(int argc, char *argv[])
+{
+    int numProfiles = (argc > 1) ? atoi(argv[1]) : 300;
+    const Estimator estimator(3);
+    const double gap = 0.05;
+    Random random = {2024};
+    uint64_t greedyBytes = 0;
+    uint64_t optimalBytes = 0;
+    int numPlans = 0;
+    for (int p = 0; p < numProfiles; p++)
+    {
+        const int numLevels = 2 + p % 3;
+        const int numBitplanes = (numLevels == 4) ? 7 : 10;
+        std::vector<std::vector<uint64_t>> levelSizes;
+        std::vector<std::vector<double>> levelErrors;
+        make_levels(numLevels, numBitplanes, random, levelSizes, levelErrors);
+        std::vector<uint8_t> startIndex(numLevels, 0);
+        if (p % 2)
+        {
+            for (int i = 0; i < numLevels; i++) startIndex[i] = (uint8_t) (random.next() * 3);
+        }
+        for (double tolerance : {20.0, 5.0, 1.0, 0.2, 0.05, 0.01, 1e-3})
+        {
+            std::string what = "profile " + std::to_string(p) + ", tolerance " + std::to_string(tolerance);
+            uint64_t optimum = brute_force(levelSizes, levelErrors, startIndex, estimator, estimator.translate_tolerance(tolerance));
+            auto exact = MDR::RDOptimalSizeInterpreter<Estimator>(estimator);
+            std::vector<uint8_t> index(startIndex);
+            auto sizes = exact.interpret_retrieve_size(levelSizes, levelErrors, tolerance, index);
+            uint64_t size = std::accumulate(sizes.begin(), sizes.end(), (uint64_t) 0);
+            if (optimum == UINT64_MAX)
+            {
+                // tolerance cannot be met: nothing to compare
+                continue;
+            }
+            check(exact.get_estimated_error() < estimator.translate_tolerance(tolerance), what + ": plan meets the tolerance");
+            check(size == optimum, what + ": size " + std::to_string(size) + " is the optimum " + std::to_string(optimum));
+
+            auto approximate = MDR::RDOptimalSizeInterpreter<Estimator>(estimator, gap);
+            std::vector<uint8_t> approximateIndex(startIndex);
+            auto approximateSizes = approximate.interpret_retrieve_size(levelSizes, levelErrors, tolerance, approximateIndex);
+            uint64_t approximateSize = std::accumulate(approximateSizes.begin(), approximateSizes.end(), (uint64_t) 0);
+            check(approximate.get_estimated_error() < estimator.translate_tolerance(tolerance), what + ": plan with gap meets the tolerance");
+            check(approximateSize <= optimum * pow(1 + gap, numLevels), what + ": size with gap is within the bound");
+
+            auto greedy = MDR::SignExcludeGreedyBasedSizeInterpreter<Estimator>(estimator);
+            std::vector<uint8_t> greedyIndex(startIndex);
+            auto greedySizes = greedy.interpret_retrieve_size(levelSizes, levelErrors, tolerance, greedyIndex);
+            greedyBytes += std::accumulate(greedySizes.begin(), greedySizes.end(), (uint64_t) 0);
+            optimalBytes += size;
+            numPlans++;
+        }
+    }
+    std::cout << numPlans << " plans: greedy " << greedyBytes << " bytes, rate-distortion optimal " << optimalBytes << " bytes";
+    if (greedyBytes)
+    {
+        std::cout << " (" << 100.0 * ((double) greedyBytes - (double) optimalBytes) / greedyBytes << "% saved)";
+    }
+    std::cout << std::endl;
+    if (failures)
+    {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "rate-distortion optimal test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <vector>
+#include <string>
+#include <cstdint>
+// no <cstring> or <iostream> before the lossless compressor headers, which must include them
+#include "../include/LosslessCompressor/LevelCompressor.hpp"
+
+// regression test for the stream header of compressed bitplanes
+// 1. streams with a StreamHeader round-trip for the ZSTD and stored codecs, with and without checksum
+// 2. streams written before StreamHeader, with a raw size_t size prefix, still decode through ZSTD and the level compressor
+// usage: stream_header_test
+
+int failures = 0;
+
+void check(bool condition, const std::string& what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+std::vector<uint8_t> make_data(size_t n, bool compressible)
+{
+    std::vector<uint8_t> data(n);
+    uint32_t state = 12345;
+    for (size_t i = 0; i < n; i++)
+    {
+        state = state * 1103515245u + 12345u;
+        data[i] = compressible ? (uint8_t) ((i / 16) % 7) : (uint8_t) (state >> 24);
+    }
+    return data;
+}
+
+// stream as written before StreamHeader: native size_t raw size, then the ZSTD frame
+std::vector<uint8_t> legacy_compress(const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> stream(sizeof(size_t) + ZSTD_compressBound(data.size()));
+    size_t rawSize = data.size();
+    memcpy(stream.data(), &rawSize, sizeof(size_t));
+    size_t outSize = ZSTD_compress(stream.data() + sizeof(size_t), stream.size() - sizeof(size_t), data.data(), data.size(), ZSTD_LEVEL);
+    stream.resize(sizeof(size_t) + outSize);
+    return stream;
+}
+
+void test_header(size_t n, bool compressible, bool checksum)
+{
+    std::string what = std::to_string(n) + (compressible ? " compressible" : " incompressible") + (checksum ? " checksummed" : "") + " bytes";
+    std::vector<uint8_t> data = make_data(n, compressible);
+    uint8_t * compressed = NULL;
+    uint64_t compressedSize = MDR::ZSTD::compress(data.data(), data.size(), &compressed, checksum);
+    size_t legacySize = 0;
+    check(!MDR::ZSTD::is_legacy_stream(compressed, compressedSize, legacySize), what + " are not taken for a legacy stream");
+    check(MDR::ZSTD::get_decompressed_size(compressed, compressedSize) == n, what + " record their size");
+    uint8_t * decompressed = NULL;
+    uint64_t decompressedSize = MDR::ZSTD::decompress(compressed, compressedSize, &decompressed);
+    check((decompressedSize == n) && (memcmp(decompressed, data.data(), n) == 0), what + " round-trip");
+    free(decompressed);
+    free(compressed);
+}
+
+void test_legacy(size_t n)
+{
+    std::string what = "legacy stream of " + std::to_string(n) + " bytes";
+    std::vector<uint8_t> data = make_data(n, true);
+    std::vector<uint8_t> stream = legacy_compress(data);
+    size_t legacySize = 0;
+    check(MDR::ZSTD::is_legacy_stream(stream.data(), stream.size(), legacySize) && (legacySize == n), what + " is detected");
+    check(MDR::ZSTD::get_decompressed_size(stream.data(), stream.size()) == n, what + " reports its size");
+    std::vector<uint8_t> buffer(n);
+    check((MDR::ZSTD::decompress(stream.data(), stream.size(), buffer.data(), n) == n) && (buffer == data), what + " decodes into a buffer");
+
+    // two bitplanes through the arena of the level compressor
+    std::vector<const uint8_t*> streams = {stream.data(), stream.data()};
+    std::vector<uint64_t> streamSizes = {stream.size(), stream.size()};
+    MDR::DefaultLevelCompressor compressor;
+    compressor.decompress_level_to_arena(streams, streamSizes, 0, 2, 0, 0);
+    check((memcmp(streams[0], data.data(), n) == 0) && (memcmp(streams[1], data.data(), n) == 0), what + " decodes through the level compressor");
+}
+
+int main(int argc, char *argv[])
+{
+    for (size_t n : {1, 100, 4096, 1 << 20})
+    {
+        for (bool compressible : {true, false})
+        {
+            test_header(n, compressible, false);
+            test_header(n, compressible, true);
+        }
+        test_legacy(n);
+    }
+    if (failures)
+    {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "stream header test passed" << std::endl;
+    return 0;
+}
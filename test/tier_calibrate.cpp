@@ -0,0 +1,170 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../include/SizeInterpreter/CostAwareSizeInterpreter.hpp"
+
+// measure latency and bandwidth of storage tiers with synthetic reads and write them as a tier cost model file
+// usage: tier_calibrate -t [# of tiers] [tier paths] -s [bytes per read] -n [# of repetitions] -o [cost model file]
+
+double elapsed(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool write_file(const std::string& filename, const std::vector<char>& data)
+{
+    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    size_t written = 0;
+    while (written < data.size())
+    {
+        ssize_t n = write(fd, data.data()+written, data.size()-written);
+        if (n <= 0)
+        {
+            close(fd);
+            return false;
+        }
+        written += n;
+    }
+    fsync(fd);
+    // drop the written pages so that reads hit the device
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+    return true;
+}
+
+// time to open and read a whole file, with its pages dropped from the page cache first
+double timed_read(const std::string& filename, std::vector<char>& buffer)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+    auto start = std::chrono::steady_clock::now();
+    fd = open(filename.c_str(), O_RDONLY);
+    size_t total = 0;
+    ssize_t n = 0;
+    while ((n = read(fd, buffer.data()+total, buffer.size()-total)) > 0)
+    {
+        total += n;
+    }
+    close(fd);
+    return elapsed(start);
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> tierPaths;
+    size_t readSize = 64 << 20;
+    size_t repetitions = 5;
+    std::string outputFileName = "tier_cost_model.txt";
+    for (int i = 0; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-t" || arg == "--tiers")
+        {
+            int tiers = (i+1 < argc) ? atoi(argv[i+1]) : 0;
+            if (tiers <= 0 || i+1+tiers >= argc)
+            {
+                std::cerr << "--tiers option requires [# of tiers] and one path per tier." << std::endl;
+                return 1;
+            }
+            for (int j = i+2; j < i+2+tiers; j++)
+            {
+                tierPaths.push_back(argv[j]);
+            }
+        }
+        else if (arg == "-s" || arg == "--size")
+        {
+            if (i+1 < argc)
+            {
+                readSize = atol(argv[i+1]);
+            }
+            else
+            {
+                std::cerr << "--size option requires one argument." << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "-n" || arg == "--repetitions")
+        {
+            if (i+1 < argc)
+            {
+                repetitions = atoi(argv[i+1]);
+            }
+            else
+            {
+                std::cerr << "--repetitions option requires one argument." << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "-o" || arg == "--output")
+        {
+            if (i+1 < argc)
+            {
+                outputFileName = argv[i+1];
+            }
+            else
+            {
+                std::cerr << "--output option requires one argument." << std::endl;
+                return 1;
+            }
+        }
+    }
+    if (tierPaths.empty() || repetitions == 0)
+    {
+        std::cerr << "usage: " << argv[0] << " -t [# of tiers] [tier paths] -s [bytes per read] -n [# of repetitions] -o [cost model file]" << std::endl;
+        return 1;
+    }
+
+    const size_t smallSize = 4096;
+    std::vector<char> data(readSize);
+    srand(0);
+    for (size_t i = 0; i < readSize; i++)
+    {
+        data[i] = rand();
+    }
+    std::vector<char> smallData(data.begin(), data.begin()+std::min(smallSize, readSize));
+    std::vector<char> buffer(readSize);
+
+    std::vector<MDR::TierCostModel> tierModels;
+    for (size_t i = 0; i < tierPaths.size(); i++)
+    {
+        std::string smallFileName = tierPaths[i]+"/.calibrate_small";
+        std::string largeFileName = tierPaths[i]+"/.calibrate_large";
+        if (!write_file(smallFileName, smallData) || !write_file(largeFileName, data))
+        {
+            std::cerr << "cannot write synthetic files to tier " << i << ": " << tierPaths[i] << std::endl;
+            return 1;
+        }
+        double latency = 0;
+        double largeTime = 0;
+        for (size_t r = 0; r < repetitions; r++)
+        {
+            latency += timed_read(smallFileName, buffer);
+            largeTime += timed_read(largeFileName, buffer);
+        }
+        latency /= repetitions;
+        largeTime /= repetitions;
+        double bandwidth = readSize / std::max(largeTime - latency, 1e-9);
+        tierModels.push_back(MDR::TierCostModel(latency, bandwidth));
+        std::cout << "tier " << i << ": " << tierPaths[i] << ", latency " << latency << " s, bandwidth " << bandwidth / (1 << 20) << " MB/s" << std::endl;
+        unlink(smallFileName.c_str());
+        unlink(largeFileName.c_str());
+    }
+    MDR::save_tier_cost_models(outputFileName, tierModels);
+    std::cout << "tier cost models written to " << outputFileName << std::endl;
+    return 0;
+}
@@ -0,0 +1,220 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "../include/Decomposer/Decomposer.hpp"
+#include "../include/Interleaver/Interleaver.hpp"
+#include "../include/BitplaneEncoder/BitplaneEncoder.hpp"
+#include "../include/LosslessCompressor/LevelCompressor.hpp"
+#include "../include/RefactorUtils.hpp"
+
+// compare the bitplane transforms of TransformLevelCompressor against plain ZSTD per level
+// every level is encoded once, then compressed with each transform and the probed choice; transform none is plain ZSTD
+// of every bitplane, as DefaultLevelCompressor does; each variant is decompressed and checked against the encoded bitplanes
+// usage: transform_benchmark -i [raw float file] -d [# of dimensions] [dimensions] -l [# of levels] -b [# of bitplanes] -p [probe bytes]
+
+using T = float;
+using T_stream = uint32_t;
+
+double elapsed(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct VariantResult
+{
+    std::string name;
+    uint64_t compressedSize = 0;
+    double compressTime = 0;
+    double decompressTime = 0;
+    uint8_t transform = BITPLANE_TRANSFORM_NONE;
+    bool matched = true;
+};
+
+// compress a copy of the streams and decompress it back
+template <class Compressor>
+VariantResult run_variant(const std::string& name, Compressor& compressor, const std::vector<std::vector<uint8_t>>& streams, int level)
+{
+    VariantResult result;
+    result.name = name;
+    std::vector<uint8_t*> compressed(streams.size());
+    std::vector<uint64_t> compressedSizes(streams.size());
+    for (size_t j = 0; j < streams.size(); j++)
+    {
+        compressed[j] = (uint8_t *) malloc(streams[j].size());
+        memcpy(compressed[j], streams[j].data(), streams[j].size());
+        compressedSizes[j] = streams[j].size();
+    }
+    auto start = std::chrono::steady_clock::now();
+    result.transform = compressor.compress_level(compressed, compressedSizes);
+    result.compressTime = elapsed(start);
+    for (size_t j = 0; j < streams.size(); j++)
+    {
+        result.compressedSize += compressedSizes[j];
+    }
+    std::vector<const uint8_t*> views(compressed.begin(), compressed.end());
+    start = std::chrono::steady_clock::now();
+    compressor.decompress_level_to_arena(views, compressedSizes, 0, streams.size(), result.transform, level);
+    result.decompressTime = elapsed(start);
+    for (size_t j = 0; j < streams.size(); j++)
+    {
+        if (memcmp(views[j], streams[j].data(), streams[j].size()) != 0)
+        {
+            result.matched = false;
+        }
+        free(compressed[j]);
+    }
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string inputFileName;
+    std::vector<uint32_t> dimensions;
+    int levels = 3;
+    int numBitplanes = 32;
+    uint32_t probeSize = 1 << 14;
+    for (int i = 0; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-i" || arg == "--input")
+        {
+            if (i+1 < argc)
+            {
+                inputFileName = argv[i+1];
+            }
+        }
+        else if (arg == "-d" || arg == "--dimensions")
+        {
+            int numDims = (i+1 < argc) ? atoi(argv[i+1]) : 0;
+            if (numDims <= 0 || i+1+numDims >= argc)
+            {
+                std::cerr << "Invalid dimensions" << std::endl;
+                return 1;
+            }
+            for (int j = 0; j < numDims; j++)
+            {
+                dimensions.push_back(atoi(argv[i+2+j]));
+            }
+        }
+        else if (arg == "-l" || arg == "--levels")
+        {
+            if (i+1 < argc)
+            {
+                levels = atoi(argv[i+1]);
+            }
+        }
+        else if (arg == "-b" || arg == "--bitplanes")
+        {
+            if (i+1 < argc)
+            {
+                numBitplanes = atoi(argv[i+1]);
+            }
+        }
+        else if (arg == "-p" || arg == "--probe")
+        {
+            if (i+1 < argc)
+            {
+                probeSize = atoi(argv[i+1]);
+            }
+        }
+    }
+    if (inputFileName.empty() || dimensions.empty())
+    {
+        std::cerr << "usage: transform_benchmark -i [raw float file] -d [# of dimensions] [dimensions] -l [# of levels] -b [# of bitplanes] -p [probe bytes]" << std::endl;
+        return 1;
+    }
+
+    size_t numElements = 1;
+    for (size_t i = 0; i < dimensions.size(); i++)
+    {
+        numElements *= dimensions[i];
+    }
+    std::vector<T> data(numElements);
+    FILE * file = fopen(inputFileName.c_str(), "rb");
+    if (file == NULL || fread(data.data(), sizeof(T), numElements, file) != numElements)
+    {
+        std::cerr << "Cannot read " << numElements << " values from " << inputFileName << std::endl;
+        return 1;
+    }
+    fclose(file);
+
+    uint8_t targetLevel = levels - 1;
+    uint8_t maxLevel = log2(*std::min_element(dimensions.begin(), dimensions.end())) - 1;
+    if (targetLevel > maxLevel)
+    {
+        std::cerr << "Target level is higher than " << +maxLevel << std::endl;
+        return 1;
+    }
+    auto decomposer = MDR::MGARDOrthoganalDecomposer<T>();
+    auto interleaver = MDR::DirectInterleaver<T>();
+    auto encoder = MDR::NegaBinaryBPEncoder<T, T_stream>();
+    decomposer.decompose(data.data(), dimensions, targetLevel);
+    auto levelDims = MDR::compute_level_dims(dimensions, targetLevel);
+    auto levelElements = MDR::compute_level_elements(levelDims, targetLevel);
+    std::vector<uint32_t> dimsDummy(dimensions.size(), 0);
+
+    std::vector<MDR::TransformLevelCompressor> transformCompressors;
+    for (int t = 0; t < BITPLANE_TRANSFORM_NUM; t++)
+    {
+        transformCompressors.push_back(MDR::TransformLevelCompressor(sizeof(T_stream), probeSize, t));
+    }
+    auto probeCompressor = MDR::TransformLevelCompressor(sizeof(T_stream), probeSize);
+
+    bool allMatched = true;
+    std::vector<uint64_t> totalSizes(BITPLANE_TRANSFORM_NUM + 1, 0);
+    std::vector<std::string> names;
+    std::cout << "level,variant,transform,raw_bytes,compressed_bytes,ratio_vs_none,compress_s,decompress_s" << std::endl;
+    for (size_t i = 0; i <= targetLevel; i++)
+    {
+        const std::vector<uint32_t>& prevDims = (i == 0) ? dimsDummy : levelDims[i - 1];
+        std::vector<T> buffer(levelElements[i]);
+        interleaver.interleave(data.data(), dimensions, levelDims[i], prevDims, buffer.data());
+        T levelMaxError = MDR::compute_max_abs_value(buffer.data(), levelElements[i]);
+        int levelExp = 0;
+        frexp(levelMaxError, &levelExp);
+        std::vector<uint64_t> streamSizes;
+        auto encoded = encoder.encode(buffer.data(), levelElements[i], levelExp, numBitplanes, streamSizes);
+        std::vector<std::vector<uint8_t>> streams(encoded.size());
+        uint64_t rawSize = 0;
+        for (size_t j = 0; j < encoded.size(); j++)
+        {
+            streams[j] = std::vector<uint8_t>(encoded[j], encoded[j] + streamSizes[j]);
+            rawSize += streamSizes[j];
+            free(encoded[j]);
+        }
+
+        std::vector<VariantResult> results;
+        for (int t = 0; t < BITPLANE_TRANSFORM_NUM; t++)
+        {
+            results.push_back(run_variant(MDR::BitplaneTransform::name(t), transformCompressors[t], streams, i));
+        }
+        results.push_back(run_variant("probe", probeCompressor, streams, i));
+        for (size_t k = 0; k < results.size(); k++)
+        {
+            const VariantResult& result = results[k];
+            std::cout << i << "," << result.name << "," << MDR::BitplaneTransform::name(result.transform) << "," << rawSize << "," << result.compressedSize << ","
+                      << (double) result.compressedSize / results[0].compressedSize << "," << result.compressTime << "," << result.decompressTime << std::endl;
+            totalSizes[k] += result.compressedSize;
+            allMatched = allMatched && result.matched;
+            if (i == 0)
+            {
+                names.push_back(result.name);
+            }
+            if (!result.matched)
+            {
+                std::cerr << "level " << i << " variant " << result.name << " does not round-trip" << std::endl;
+            }
+        }
+    }
+    for (size_t k = 0; k < names.size(); k++)
+    {
+        std::cout << "total," << names[k] << ",,," << totalSizes[k] << "," << (double) totalSizes[k] / totalSizes[0] << ",," << std::endl;
+    }
+    return allMatched ? 0 : 1;
+}
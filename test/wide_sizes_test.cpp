@@ -0,0 +1,186 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../include/Refactor/Refactor.hpp"
+#include "../include/Reconstructor/Reconstructor.hpp"
+#include "../include/Retriever/CachedFileRetriever.hpp"
+
+// regression test for 64-bit bitplane sizes and offsets
+// 1. metadata written with METADATA_FLAG_WIDE_SIZES round-trips, and the same metadata rewritten with the older 32-bit
+//    sizes (flag cleared) loads through deserialize_widened and reconstructs the same data
+// 2. components placed past UINT32_MAX in a sparse level file are read back by read_file_range and by a retriever
+//    that seeks to them from the level sizes
+// usage: wide_sizes_test [scratch directory]
+
+using T = float;
+using Decomposer = MDR::MGARDOrthoganalDecomposer<T>;
+using Interleaver = MDR::DirectInterleaver<T>;
+using Encoder = MDR::NegaBinaryBPEncoder<T, uint32_t>;
+using Compressor = MDR::DefaultLevelCompressor;
+using Estimator = MDR::MaxErrorEstimatorOB<T>;
+using Interpreter = MDR::SignExcludeGreedyBasedSizeInterpreter<Estimator>;
+
+int failures = 0;
+
+void check(bool condition, const std::string& what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+std::vector<uint8_t> read_whole_file(const std::string& filename)
+{
+    FILE * file = fopen(filename.c_str(), "rb");
+    fseek(file, 0, SEEK_END);
+    size_t size = ftell(file);
+    rewind(file);
+    std::vector<uint8_t> data(size);
+    fread(data.data(), 1, size, file);
+    fclose(file);
+    return data;
+}
+
+void write_whole_file(const std::string& filename, const std::vector<uint8_t>& data)
+{
+    FILE * file = fopen(filename.c_str(), "wb");
+    fwrite(data.data(), 1, data.size(), file);
+    fclose(file);
+}
+
+std::vector<T> reconstruct(const std::string& metadataFile, const std::vector<std::string>& levelFiles, double tolerance)
+{
+    auto reconstructor = MDR::ComposedReconstructor<T, Decomposer, Interleaver, Encoder, Compressor, Interpreter, Estimator, MDR::ConcatLevelFileRetriever>(
+        Decomposer(), Interleaver(), Encoder(), Compressor(), Interpreter(Estimator(3)), MDR::ConcatLevelFileRetriever(metadataFile, levelFiles));
+    reconstructor.load_metadata();
+    T * data = reconstructor.progressive_reconstruct(tolerance);
+    return std::vector<T>(data, data + 16 * 16 * 16);
+}
+
+// rewrite metadata with 32-bit bitplane sizes, as written before METADATA_FLAG_WIDE_SIZES
+std::vector<uint8_t> narrow_metadata(const std::vector<uint8_t>& metadata)
+{
+    std::vector<uint8_t> narrowed;
+    uint8_t const * pos = metadata.data();
+    uint8_t num_dims = *(pos++);
+    check(num_dims & METADATA_FLAG_WIDE_SIZES, "refactor sets METADATA_FLAG_WIDE_SIZES");
+    narrowed.push_back(num_dims & ~METADATA_FLAG_WIDE_SIZES);
+    num_dims &= ~(METADATA_FLAG_MAX_ERRORS | METADATA_FLAG_RETRIEVAL_PLAN | METADATA_FLAG_WIDE_SIZES);
+    uint8_t const * start = pos;
+    pos += num_dims * sizeof(uint32_t);
+    uint8_t num_levels = *(pos++);
+    pos += num_levels * sizeof(T);
+    std::vector<std::vector<double>> levelSquaredErrors;
+    MDR::deserialize(pos, num_levels, levelSquaredErrors);
+    narrowed.insert(narrowed.end(), start, pos);
+    std::vector<std::vector<uint64_t>> levelSizes;
+    MDR::deserialize(pos, num_levels, levelSizes);
+    std::vector<std::vector<uint32_t>> narrowSizes;
+    for (const auto& sizes : levelSizes)
+    {
+        narrowSizes.push_back(std::vector<uint32_t>(sizes.begin(), sizes.end()));
+    }
+    std::vector<uint8_t> buffer(MDR::get_size(narrowSizes));
+    uint8_t * bufferPos = buffer.data();
+    MDR::serialize(narrowSizes, bufferPos);
+    narrowed.insert(narrowed.end(), buffer.begin(), buffer.end());
+    narrowed.insert(narrowed.end(), pos, metadata.data() + metadata.size());
+
+    // deserialize_widened reads the narrowed sizes back
+    uint8_t const * narrowPos = buffer.data();
+    std::vector<std::vector<uint64_t>> widenedSizes;
+    MDR::deserialize_widened<uint32_t>(narrowPos, num_levels, widenedSizes);
+    check(widenedSizes == levelSizes, "deserialize_widened restores the bitplane sizes");
+    check(narrowPos == buffer.data() + buffer.size(), "deserialize_widened consumes the 32-bit sizes");
+    return narrowed;
+}
+
+void test_metadata(const std::string& directory)
+{
+    std::string metadataFile = directory + "/wide_sizes.md";
+    std::vector<std::string> levelFiles;
+    for (int i = 0; i < 3; i++)
+    {
+        levelFiles.push_back(directory + "/wide_sizes.level." + std::to_string(i));
+    }
+    std::vector<T> data(16 * 16 * 16);
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        data[i] = sin(i * 0.1) * (1 + i % 7);
+    }
+    auto refactor = MDR::ComposedRefactor<T, Decomposer, Interleaver, Encoder, Compressor, MDR::SquaredErrorCollector<T>, MDR::ConcatLevelFileWriter>(
+        Decomposer(), Interleaver(), Encoder(), Compressor(), MDR::SquaredErrorCollector<T>(), MDR::ConcatLevelFileWriter(metadataFile, levelFiles));
+    refactor.refactor(data.data(), {16, 16, 16}, 2, 32);
+
+    const double tolerance = 1e-3;
+    std::vector<T> wide = reconstruct(metadataFile, levelFiles, tolerance);
+    double maxError = 0;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        maxError = std::max(maxError, (double) fabs(wide[i] - data[i]));
+    }
+    check(maxError < tolerance, "reconstruction from wide metadata meets the tolerance");
+
+    std::string narrowMetadataFile = directory + "/wide_sizes.narrow.md";
+    write_whole_file(narrowMetadataFile, narrow_metadata(read_whole_file(metadataFile)));
+    std::vector<T> narrow = reconstruct(narrowMetadataFile, levelFiles, tolerance);
+    check(narrow == wide, "reconstruction from 32-bit metadata matches");
+
+    remove(metadataFile.c_str());
+    remove(narrowMetadataFile.c_str());
+    for (const auto& levelFile : levelFiles)
+    {
+        remove(levelFile.c_str());
+    }
+}
+
+void test_offsets(const std::string& directory)
+{
+    // a skipped component of UINT32_MAX + 100 bytes, then the component read back; the file is sparse
+    std::string levelFile = directory + "/wide_sizes.sparse";
+    const uint64_t skipped = (uint64_t) UINT32_MAX + 100;
+    const char marker[] = "past 4 GiB";
+    int fd = open(levelFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || pwrite(fd, marker, sizeof(marker), skipped) != sizeof(marker))
+    {
+        std::cerr << "Cannot write " << levelFile << std::endl;
+        failures++;
+        if (fd >= 0) close(fd);
+        return;
+    }
+    close(fd);
+
+    std::vector<uint8_t> buffer(sizeof(marker));
+    MDR::read_file_range(levelFile, skipped, sizeof(marker), buffer.data());
+    check(memcmp(buffer.data(), marker, sizeof(marker)) == 0, "read_file_range reads past UINT32_MAX");
+
+    MDR::ComponentCache cache;
+    auto retriever = MDR::CachedLevelFileRetriever("", {levelFile}, "wide_sizes", "sparse", cache);
+    std::vector<std::vector<uint64_t>> levelSizes = {{skipped, sizeof(marker)}};
+    auto components = retriever.retrieve_level_components(levelSizes, {sizeof(marker)}, {1}, {2});
+    check(components.size() == 1 && components[0].size() == 1, "retriever returns the requested component");
+    check(memcmp(components[0][0], marker, sizeof(marker)) == 0, "retriever reads a component past UINT32_MAX");
+    remove(levelFile.c_str());
+}
+
+int main(int argc, char *argv[])
+{
+    std::string directory = (argc > 1) ? argv[1] : "/tmp";
+    test_metadata(directory);
+    test_offsets(directory);
+    if (failures)
+    {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "wide sizes test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#include "../include/Refactor/Refactor.hpp"
+#include "../include/Reconstructor/Reconstructor.hpp"
+
+// regression test for the level counts of WriteBehindLevelFileWriter
+// the writer is given more level files than the refactor writes levels; the metadata must record only the levels
+// written, so that the max errors and the retrieval plan after the level counts load aligned
+// usage: write_behind_test [scratch directory]
+
+using T = float;
+using Decomposer = MDR::MGARDOrthoganalDecomposer<T>;
+using Interleaver = MDR::DirectInterleaver<T>;
+using Encoder = MDR::NegaBinaryBPEncoder<T, uint32_t>;
+using Compressor = MDR::DefaultLevelCompressor;
+using Estimator = MDR::MaxErrorEstimatorOB<T>;
+using Interpreter = MDR::SignExcludeGreedyBasedSizeInterpreter<Estimator>;
+
+int failures = 0;
+
+void check(bool condition, const std::string& what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+std::vector<T> reconstruct(const std::string& metadataFile, const std::vector<std::string>& levelFiles, double tolerance, size_t numElements)
+{
+    auto reconstructor = MDR::ComposedReconstructor<T, Decomposer, Interleaver, Encoder, Compressor, Interpreter, Estimator, MDR::ConcatLevelFileRetriever>(
+        Decomposer(), Interleaver(), Encoder(), Compressor(), Interpreter(Estimator(3)), MDR::ConcatLevelFileRetriever(metadataFile, levelFiles));
+    reconstructor.load_metadata();
+    T * data = reconstructor.progressive_reconstruct(tolerance);
+    return std::vector<T>(data, data + numElements);
+}
+
+int main(int argc, char *argv[])
+{
+    std::string directory = (argc > 1) ? argv[1] : "/tmp";
+    std::string metadataFile = directory + "/write_behind.md";
+    std::string referenceMetadataFile = directory + "/write_behind.reference.md";
+    // 5 level files for 3 levels; the reader opens the 3 written ones
+    std::vector<std::string> levelFiles;
+    std::vector<std::string> referenceLevelFiles;
+    for (int i = 0; i < 5; i++)
+    {
+        levelFiles.push_back(directory + "/write_behind.level." + std::to_string(i));
+        if (i < 3) referenceLevelFiles.push_back(directory + "/write_behind.reference.level." + std::to_string(i));
+    }
+    std::vector<std::string> writtenLevelFiles(levelFiles.begin(), levelFiles.begin() + 3);
+    const std::vector<uint32_t> dimensions = {16, 16, 16};
+    std::vector<T> data(16 * 16 * 16);
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        data[i] = sin(i * 0.1) * (1 + i % 7);
+    }
+
+    auto refactor = MDR::ComposedRefactor<T, Decomposer, Interleaver, Encoder, Compressor, MDR::SquaredErrorCollector<T>, MDR::WriteBehindLevelFileWriter>(
+        Decomposer(), Interleaver(), Encoder(), Compressor(), MDR::SquaredErrorCollector<T>(), MDR::WriteBehindLevelFileWriter(metadataFile, levelFiles));
+    refactor.refactor(data.data(), dimensions, 2, 32);
+    auto referenceRefactor = MDR::ComposedRefactor<T, Decomposer, Interleaver, Encoder, Compressor, MDR::SquaredErrorCollector<T>, MDR::ConcatLevelFileWriter>(
+        Decomposer(), Interleaver(), Encoder(), Compressor(), MDR::SquaredErrorCollector<T>(), MDR::ConcatLevelFileWriter(referenceMetadataFile, referenceLevelFiles));
+    referenceRefactor.refactor(data.data(), dimensions, 2, 32);
+
+    for (double tolerance : {1.0, 1e-2, 1e-4})
+    {
+        std::vector<T> written = reconstruct(metadataFile, writtenLevelFiles, tolerance, data.size());
+        std::vector<T> reference = reconstruct(referenceMetadataFile, referenceLevelFiles, tolerance, data.size());
+        double maxError = 0;
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            maxError = std::max(maxError, (double) fabs(written[i] - data[i]));
+        }
+        check(maxError < tolerance, "reconstruction from write-behind files meets tolerance " + std::to_string(tolerance));
+        check(written == reference, "reconstruction matches the concatenating writer at tolerance " + std::to_string(tolerance));
+    }
+
+    remove(metadataFile.c_str());
+    remove(referenceMetadataFile.c_str());
+    for (const auto& levelFile : levelFiles)
+    {
+        remove(levelFile.c_str());
+    }
+    for (const auto& levelFile : referenceLevelFiles)
+    {
+        remove(levelFile.c_str());
+    }
+    if (failures)
+    {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "write behind test passed" << std::endl;
+    return 0;
+}